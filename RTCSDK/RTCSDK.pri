@@ -23,8 +23,14 @@ HEADERS += ./audio_device_manager.h \
     ./i_signaling_event_handler.h \
     ./i_webrtc_event_handler.h \
     ./janus_api_client.h \
+    ./janus_message.h \
+    ./transaction_manager.h \
+    ./send_queue.h \
+    ./unix_socket_transport.h \
     ./json/jsonable.hpp \
     ./json/serialization_json.hpp \
+    ./json/serialization_json_sax.hpp \
+    ./json/serialization_json_writer.hpp \
     ./json/stringable.hpp \
     ./json/string_algo.hpp \
     ./rtc_engine_factory.h \
@@ -36,6 +42,7 @@ HEADERS += ./audio_device_manager.h \
     ./logger/rtc_log_sink.h \
     ./media_controller.h \
     ./media_controller_interface.h \
+    ./video_layer.h \
     ./message_models.h \
     ./message_transport.h \
     ./participant.h \
@@ -52,6 +59,9 @@ HEADERS += ./audio_device_manager.h \
     ./service/unified_factory.h \
     ./signaling_client_status.h \
     ./text_room_client.h \
+    ./teardown_coordinator.h \
+    ./subscription_quality_controller.h \
+    ./subscription_manager.h \
     ./utils/interface_proxy.hpp \
     ./utils/i_notification.h \
     ./utils/i_observer.hpp \
@@ -65,16 +75,21 @@ HEADERS += ./audio_device_manager.h \
     ./utils/observer.hpp \
     ./utils/service_factory.hpp \
     ./utils/singleton.h \
+    ./utils/strand_pool.h \
     ./utils/task_scheduler.h \
+    ./utils/timer_wheel.h \
+    ./utils/latency_histogram.h \
     ./utils/thread_provider.h \
     ./utils/universal_observable.hpp \
     ./video_device_manager.h \
     ./video_room_client.h \
     ./video_room_api.h \
+    ./video_room_api_async.h \
     ./video_room_client_interface.h \
     ./video_room_models.h \
     ./video_room_subscriber.h \
     ./weak_proxy.h \
+    ./proxy_future.h \
     ./signaling_client.h \
     ./signaling_events.h \
     ./signaling_client_interface.h \
@@ -82,15 +97,21 @@ HEADERS += ./audio_device_manager.h \
     ./websocket/connection_metadata.h \
     ./websocket/i_connection_listener.h \
     ./websocket/websocket_endpoint.h \
+    ./websocket/websocket_config.h \
     ./i_video_device_manager.h
 SOURCES += ./audio_device_manager.cpp \
     ./helper_utils.cpp \
     ./i_audio_device_manager.cpp \
     ./janus_api_client.cpp \
+    ./janus_message.cpp \
+    ./transaction_manager.cpp \
+    ./send_queue.cpp \
+    ./unix_socket_transport.cpp \
     ./plugin_context.cpp \
     ./rtc_engine_factory.cpp \
     ./utils/sdp_utils.cpp \
     ./utils/string_utils.cpp \
+    ./utils/strand_pool.cpp \
     ./video_capture.cpp \
     ./logger/logger.cpp \
     ./logger/rtc_log_sink.cpp \
@@ -103,14 +124,19 @@ SOURCES += ./audio_device_manager.cpp \
     ./service/rtc_engine.cpp \
     ./service/unified_factory.cpp \
     ./text_room_client.cpp \
+    ./teardown_coordinator.cpp \
+    ./subscription_quality_controller.cpp \
+    ./subscription_manager.cpp \
     ./utils/notification_center.cpp \
     ./utils/notification_keys.cpp \
     ./utils/service_factory.cpp \
     ./utils/task_scheduler.cpp \
+    ./utils/timer_wheel.cpp \
     ./utils/thread_provider.cpp \
     ./video_device_manager.cpp \
     ./video_room_client.cpp \
     ./video_room_api.cpp \
+    ./video_room_api_async.cpp \
     ./video_room_subscriber.cpp \
     ./weak_proxy.cpp \
     ./signaling_client.cpp \
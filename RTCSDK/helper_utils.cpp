@@ -86,4 +86,42 @@ namespace vi {
 			return true;	// Default is true
 		return (trickle == true);
 	}
+
+	std::vector<VideoLayer> HelperUtils::videoLayers(std::shared_ptr<PrepareWebrtcEvent> event) {
+		if (event->media && !event->media->videoLayers.empty())
+			return event->media->videoLayers;
+		if (event->simulcast2.value_or(false))
+			return VideoLayer::defaultSimulcast();
+		return {};
+	}
+
+	webrtc::RtpEncodingParameters HelperUtils::toRtpEncoding(const VideoLayer& layer) {
+		webrtc::RtpEncodingParameters encoding;
+		encoding.rid = layer.rid;
+		updateRtpEncoding(layer, encoding);
+		return encoding;
+	}
+
+	VideoLayer HelperUtils::toVideoLayer(const webrtc::RtpEncodingParameters& encoding) {
+		VideoLayer layer;
+		layer.rid = encoding.rid;
+		layer.active = encoding.active;
+		layer.maxBitrateBps = encoding.max_bitrate_bps;
+		layer.maxFramerate = encoding.max_framerate;
+		layer.scaleResolutionDownBy = encoding.scale_resolution_down_by;
+		layer.scalabilityMode = encoding.scalability_mode;
+		return layer;
+	}
+
+	void HelperUtils::updateRtpEncoding(const VideoLayer& layer, webrtc::RtpEncodingParameters& encoding) {
+		encoding.active = layer.active;
+		if (layer.maxBitrateBps)
+			encoding.max_bitrate_bps = layer.maxBitrateBps;
+		if (layer.maxFramerate)
+			encoding.max_framerate = layer.maxFramerate;
+		if (layer.scaleResolutionDownBy)
+			encoding.scale_resolution_down_by = layer.scaleResolutionDownBy;
+		if (layer.scalabilityMode)
+			encoding.scalability_mode = layer.scalabilityMode;
+	}
 }
\ No newline at end of file
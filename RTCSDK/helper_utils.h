@@ -30,6 +30,16 @@ namespace vi {
 		static bool isDataEnabled(const absl::optional<MediaConfig>& media);
 
 		static bool isTrickleEnabled(const absl::optional<bool>& trickle);
+
+		// Layers to publish the video track with, empty for a single plain encoding
+		static std::vector<VideoLayer> videoLayers(std::shared_ptr<PrepareWebrtcEvent> event);
+
+		static webrtc::RtpEncodingParameters toRtpEncoding(const VideoLayer& layer);
+
+		static VideoLayer toVideoLayer(const webrtc::RtpEncodingParameters& encoding);
+
+		// Copies the fields set in |layer| into |encoding|, the rid is not touched
+		static void updateRtpEncoding(const VideoLayer& layer, webrtc::RtpEncodingParameters& encoding);
 	};
 
 }
\ No newline at end of file
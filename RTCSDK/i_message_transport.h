@@ -9,16 +9,55 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <memory>
+#include <array>
+#include "json/serialization_json_writer.hpp"
+#include "utils/latency_histogram.h"
 
 namespace vi {
 	using JCCallback = std::function<void(const std::string& json)>;
 	
 	class IMessageTransportListener;
 
+	// Request kinds tracked separately by the transaction latency histograms
+	enum class TransactionKind : uint32_t {
+		CREATE = 0,
+		ATTACH,
+		MESSAGE,
+		TRICKLE,
+		KEEPALIVE,
+		HANGUP,
+		OTHER,
+		COUNT
+	};
+
+	struct TransactionStats {
+		uint64_t pending = 0;
+		uint64_t completed = 0;
+		uint64_t timedOut = 0;
+		uint64_t rejected = 0;
+	};
+
+	// Outbound priority classes, lower values go out first
+	enum class SendPriority : uint32_t {
+		URGENT = 0,		// keepalive, hangup
+		TRICKLE,
+		BULK,			// plugin messages and everything else
+		COUNT
+	};
+
+	struct SendQueueStats {
+		std::array<uint64_t, (size_t)SendPriority::COUNT> depth{};
+		// time spent queued, per class
+		std::array<LatencyHistogram::Snapshot, (size_t)SendPriority::COUNT> wait;
+		uint64_t coalesced = 0;
+	};
+
 	struct JCHandler {
-		JCHandler(std::string trans, std::shared_ptr<JCCallback> cb)
+		JCHandler(std::string trans, std::shared_ptr<JCCallback> cb, TransactionKind k = TransactionKind::OTHER)
 		: transaction(trans)
-		, callback(cb) {
+		, callback(cb)
+		, kind(k) {
 
 		}
 
@@ -28,6 +67,9 @@ namespace vi {
 
 		std::string transaction;
 		std::shared_ptr<JCCallback> callback;
+		TransactionKind kind;
+		// a queued request with the same non-empty key is replaced by this one
+		std::string coalesceKey;
 	};
 
 	class IMessageTransport {
@@ -46,9 +88,29 @@ namespace vi {
 
 		virtual void disconnect() = 0;
 
+		virtual bool isOpen() = 0;
+
+		// Re-sends the requests still waiting for a response, e.g. after the session was claimed on a new socket.
+		virtual void replayPending() = 0;
+
+		// The send queue is held from the moment the connection drops until resume(), so that nothing
+		// queued during the outage goes out before the session is claimed (or a new one created).
+		virtual void resume() = 0;
+
 		virtual void send(const std::string& data, std::shared_ptr<JCHandler> handler) = 0;
 
 		virtual void send(const std::vector<uint8_t>& data, std::shared_ptr<JCHandler> handler) = 0;
 
+		virtual void send(JsonBufferPtr data, std::shared_ptr<JCHandler> handler) = 0;
+
+		// Written ahead of the send queue, also while it is held, e.g. the claim of a session.
+		virtual void sendUrgent(JsonBufferPtr data, std::shared_ptr<JCHandler> handler) = 0;
+
+		virtual LatencyHistogram::Snapshot transactionLatency(TransactionKind kind) = 0;
+
+		virtual TransactionStats transactionStats() = 0;
+
+		virtual SendQueueStats sendQueueStats() = 0;
+
 	};
 }
@@ -7,8 +7,11 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 namespace vi {
+	class JanusMessage;
+
 	class IMessageTransportListener
 	{
 	public:
@@ -20,7 +23,7 @@ namespace vi {
 
 		virtual void onFailed(int errorCode, const std::string& reason) = 0;
 
-		virtual void onMessage(const std::string& json) = 0;
+		virtual void onMessage(std::shared_ptr<const JanusMessage> message) = 0;
 
 	};
 }
\ No newline at end of file
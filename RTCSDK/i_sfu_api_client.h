@@ -7,6 +7,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <functional>
 #include "i_sfu_api_client_listener.h"
 
@@ -36,10 +37,19 @@ namespace vi {
 
 		virtual void detach(int64_t sessionId, int64_t handleId, std::shared_ptr<JCCallback> callback) = 0;
 
-		virtual void sendMessage(int64_t sessionId, int64_t handleId, const std::string& message, const std::string& jsep, std::shared_ptr<JCCallback> callback) = 0;
+		// A still queued message of |handleId| with the same non-empty |coalesceKey| is replaced by this one.
+		virtual void sendMessage(int64_t sessionId, int64_t handleId, const std::string& message, const std::string& jsep, const std::string& coalesceKey, std::shared_ptr<JCCallback> callback) = 0;
 
 		virtual void sendTrickleCandidate(int64_t sessionId, int64_t handleId, const CandidateData& candidate, std::shared_ptr<JCCallback> callback) = 0;
 
+		virtual void sendTrickleCandidates(int64_t sessionId, int64_t handleId, const std::vector<CandidateData>& candidates, std::shared_ptr<JCCallback> callback) = 0;
+
 		virtual void hangup(int64_t sessionId, int64_t handleId, std::shared_ptr<JCCallback> callback) = 0;
+
+		// Re-sends the requests that were in flight when the connection dropped.
+		virtual void replayPending() = 0;
+
+		// Lets out the requests held since the connection dropped, once the session is claimed or replaced.
+		virtual void resume() = 0;
 	};
 }
\ No newline at end of file
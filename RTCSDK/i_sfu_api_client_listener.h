@@ -10,6 +10,8 @@
 #include "message_transport.h"
 
 namespace vi {
+	class JanusMessage;
+
 	class ISfuApiClientListener
 	{
 	public:
@@ -21,6 +23,6 @@ namespace vi {
 
 		virtual void onFailed(int errorCode, const std::string& reason) = 0;
 
-		virtual void onMessage(const std::string& json) = 0;
+		virtual void onMessage(std::shared_ptr<const JanusMessage> message) = 0;
 	};
 }
\ No newline at end of file
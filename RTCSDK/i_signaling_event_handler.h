@@ -14,6 +14,8 @@
 #include "plugin_context.h"
 
 namespace vi {
+	class JanusMessage;
+	class TeardownCoordinator;
 
 	class ISignalingEventHandler
 	{
@@ -28,9 +30,9 @@ namespace vi {
 
 		virtual void onSlowLink(bool uplink, bool lost, const std::string& mid) = 0;
 
-		virtual void onTrickle(const std::string& trickle) = 0;
+		virtual void onTrickle(std::shared_ptr<const JanusMessage> trickle) = 0;
 
-		virtual void onMessage(const std::string& data, const std::string& jsep) = 0;
+		virtual void onMessage(std::shared_ptr<const JanusMessage> message) = 0;
 
 		virtual void onTimeout() = 0;
 
@@ -38,7 +40,8 @@ namespace vi {
 
 		virtual void onHangup() = 0;
 
-		virtual void onCleanup() = 0;
+		// |teardown| is set when the handle goes down together with others, its PeerConnection is closed by it then
+		virtual void onCleanup(std::shared_ptr<TeardownCoordinator> teardown) = 0;
 
 		virtual void onDetached() = 0;
 	};
@@ -6,6 +6,8 @@
 
 namespace vi {
 
+	// A callback gets the response of Janus, with janus "error" if the gateway rejected the request or it
+	// timed out, or nullptr if the request could not be sent or its response not be read.
 	class IVideoRoomApi {
 	public:
 		virtual ~IVideoRoomApi() = default;
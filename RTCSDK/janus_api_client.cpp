@@ -7,17 +7,26 @@
 #include "janus_api_client.h"
 #include <iostream>
 #include "message_transport.h"
+#include "unix_socket_transport.h"
 #include "message_models.h"
+#include "janus_message.h"
 #include "utils/string_utils.h"
 #include "logger/logger.h"
 #include "rtc_base/thread.h"
 #include "logger/logger.h"
 
 namespace vi {
+	JanusApiClient::JanusApiClient(std::shared_ptr<ThreadProvider> threads, const std::string& callbackThreadName)
+		: JanusApiClient(threads, callbackThreadName, nullptr)
+	{
+	}
 
-	JanusApiClient::JanusApiClient(const std::string& callbackThreadName) : _callbackThreadName(callbackThreadName)
+	JanusApiClient::JanusApiClient(std::shared_ptr<ThreadProvider> threads, const std::string& callbackThreadName, std::shared_ptr<WebsocketEndpoint> websocket)
+		: _callbackThread(threads->thread(callbackThreadName))
+		, _transportThread(threads->thread("message-transport"))
+		, _websocket(websocket)
+		, _transport(std::make_shared<MessageTransport>(_transportThread, websocket))
 	{
-		_transport = std::make_shared<MessageTransport>();
 	}
 
 	JanusApiClient::~JanusApiClient()
@@ -38,7 +47,7 @@ namespace vi {
 
 	void JanusApiClient::addListener(std::shared_ptr<ISfuApiClientListener> listener)
 	{
-		UniversalObservable<ISfuApiClientListener>::addWeakObserver(listener, _callbackThreadName);
+		UniversalObservable<ISfuApiClientListener>::addWeakObserver(listener, _callbackThread);
 	}
 
 	void JanusApiClient::removeListener(std::shared_ptr<ISfuApiClientListener> listener)
@@ -48,12 +57,28 @@ namespace vi {
 
 	void JanusApiClient::init()
 	{
+		_transport->init();
 		_transport->addListener(shared_from_this());
 	}
 
 	void JanusApiClient::connect(const std::string& url)
 	{
 		_url = url;
+		// the transport follows the URL scheme: unix:// or unix+dgram:// for the UnixSockets transport, websocket otherwise
+		const bool unixSocket = UnixSocketTransport::isUnixSocketUrl(url);
+		if (unixSocket != _unixSocket) {
+			_transport->removeListener(shared_from_this());
+			_transport->destroy();
+			if (unixSocket) {
+				_transport = std::make_shared<UnixSocketTransport>(_transportThread);
+			}
+			else {
+				_transport = std::make_shared<MessageTransport>(_transportThread, _websocket);
+			}
+			_unixSocket = unixSocket;
+			_transport->init();
+			_transport->addListener(shared_from_this());
+		}
 		_transport->connect(url);
 	}
 
@@ -65,11 +90,9 @@ namespace vi {
 		//request.token = _token;
 		//request.apisecret = _apisecret;
 
-		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback));
-
-		std::string data = request.toJsonStr();
+		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback), TransactionKind::CREATE);
 
-		_transport->send(data, handler);
+		_transport->send(toJsonBuffer(request), handler);
 	}
 
 	void JanusApiClient::destroySession(int64_t sessionId, std::shared_ptr<JCCallback> callback) 
@@ -83,9 +106,7 @@ namespace vi {
 
 		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback));
 
-		std::string data = request.toJsonStr();
-
-		_transport->send(data, handler);
+		_transport->send(toJsonBuffer(request), handler);
 	}
 
 	void JanusApiClient::reconnectSession(int64_t sessionId, std::shared_ptr<JCCallback> callback) 
@@ -97,11 +118,10 @@ namespace vi {
 		request.apisecret = _apisecret;
 		request.session_id = sessionId;
 
-		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback));
-
-		std::string data = request.toJsonStr();
+		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback), TransactionKind::CREATE);
 
-		_transport->send(data, handler);
+		// the queue is held until the session is claimed
+		_transport->sendUrgent(toJsonBuffer(request), handler);
 	}
 
 	void JanusApiClient::keepAlive(int64_t sessionId, std::shared_ptr<JCCallback> callback) 
@@ -113,11 +133,9 @@ namespace vi {
 		request.apisecret = _apisecret;
 		request.session_id = sessionId;
 
-		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback));
-
-		std::string data = request.toJsonStr();
+		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback), TransactionKind::KEEPALIVE);
 
-		_transport->send(data, handler);
+		_transport->send(toJsonBuffer(request), handler);
 	}
 
 	void JanusApiClient::attach(int64_t sessionId, const std::string& plugin, const std::string& opaqueId, std::shared_ptr<JCCallback> callback)
@@ -131,11 +149,9 @@ namespace vi {
 		request.plugin = plugin;
 		request.opaque_id = opaqueId;
 
-		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback));
-
-		std::string data = request.toJsonStr();
+		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback), TransactionKind::ATTACH);
 
-		_transport->send(data, handler);
+		_transport->send(toJsonBuffer(request), handler);
 	}
 
 	void JanusApiClient::detach(int64_t sessionId, int64_t handleId, std::shared_ptr<JCCallback> callback) 
@@ -150,69 +166,39 @@ namespace vi {
 
 		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback));
 
-		std::string data = request.toJsonStr();
-
-		_transport->send(data, handler);
+		_transport->send(toJsonBuffer(request), handler);
 	}
 
-	void JanusApiClient::sendMessage(int64_t sessionId, int64_t handleId, const std::string& message, const std::string& jsep, std::shared_ptr<JCCallback> callback)
+	void JanusApiClient::sendMessage(int64_t sessionId, int64_t handleId, const std::string& message, const std::string& jsep, const std::string& coalesceKey, std::shared_ptr<JCCallback> callback)
 	{
-		if (jsep.empty()) {
-			MessageRequest request;
-			request.janus = "message";
-			request.transaction = StringUtils::randomString(12);
-			request.token = _token;
-			request.apisecret = _apisecret;
-			request.session_id = sessionId;
-			request.handle_id = handleId;
-			request.body = "#-MESSAGE-#";
-
-			auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback));
-
-			std::string data = request.toJsonStr();
-			DLOG("before replace, data = {}", data.c_str());
-			std::string tag("\"#-MESSAGE-#\"");
-			size_t pos = data.find(tag);
-			if (pos != std::string::npos) {
-				data = data.replace(pos, tag.length(), message);
-			}
-			DLOG("after replace, data = {}", data.c_str());
-			_transport->send(data, handler);
-		}
-		else {
-			JsepRequest request;
-			request.janus = "message";
-			request.transaction = StringUtils::randomString(12);
-			request.token = _token;
-			request.apisecret = _apisecret;
-			request.session_id = sessionId;
-			request.handle_id = handleId;
-			request.body = "#-MESSAGE-#";
-			request.jsep = "#-JSEP-#";
-
-			auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback));
-
-			std::string data = request.toJsonStr();
-
-			DLOG("before replace, data = {}", data.c_str());
-
-			std::string tag("\"#-MESSAGE-#\"");
-			size_t pos = data.find(tag);
-			if (pos != std::string::npos) {
-				data = data.replace(pos, tag.length(), message);
-			}
-
-			tag = "\"#-JSEP-#\"";
-			pos = std::string::npos;
-			pos = data.find(tag);
-			if (pos != std::string::npos) {
-				data = data.replace(pos, tag.length(), jsep);
-			}
+		MessageRequest request;
+		request.janus = "message";
+		request.transaction = StringUtils::randomString(12);
+		request.token = _token;
+		request.apisecret = _apisecret;
+		request.session_id = sessionId;
+		request.handle_id = handleId;
 
-			DLOG("after replace, data = {}", data.c_str());
+		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback), TransactionKind::MESSAGE);
+		// a jsep has to be answered, such a message is never superseded
+		if (jsep.empty() && !coalesceKey.empty()) {
+			handler->coalesceKey = std::to_string(handleId) + ":" + coalesceKey;
+		}
 
-			_transport->send(data, handler);
+		// |message| and |jsep| are already serialized, splice them in as raw values
+		JsonBufferPtr buffer = JsonBufferPool::acquire();
+		JsonBufferWriter writer(*buffer);
+		writer.StartObject();
+		request.jwriteMembers(writer);
+		writer.Key("body");
+		writer.RawValue(message.c_str(), message.size(), rapidjson::kObjectType);
+		if (!jsep.empty()) {
+			writer.Key("jsep");
+			writer.RawValue(jsep.c_str(), jsep.size(), rapidjson::kObjectType);
 		}
+		writer.EndObject();
+
+		_transport->send(std::move(buffer), handler);
 	}
 
 	void JanusApiClient::sendTrickleCandidate(int64_t sessionId, int64_t handleId, const CandidateData& candidate, std::shared_ptr<JCCallback> callback) 
@@ -226,11 +212,25 @@ namespace vi {
 		request.handle_id = handleId;
 		request.candidate = candidate;
 
-		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback));
+		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback), TransactionKind::TRICKLE);
+
+		_transport->send(toJsonBuffer(request), handler);
+	}
+
+	void JanusApiClient::sendTrickleCandidates(int64_t sessionId, int64_t handleId, const std::vector<CandidateData>& candidates, std::shared_ptr<JCCallback> callback)
+	{
+		TrickleRequest request;
+		request.janus = "trickle";
+		request.transaction = StringUtils::randomString(12);
+		request.token = _token;
+		request.apisecret = _apisecret;
+		request.session_id = sessionId;
+		request.handle_id = handleId;
+		request.candidates = candidates;
 
-		std::string data = request.toJsonStr();
+		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback), TransactionKind::TRICKLE);
 
-		_transport->send(data, handler);
+		_transport->send(toJsonBuffer(request), handler);
 	}
 
 	void JanusApiClient::hangup(int64_t sessionId, int64_t handleId, std::shared_ptr<JCCallback> callback) 
@@ -243,11 +243,19 @@ namespace vi {
 		request.session_id = sessionId;
 		request.handle_id = handleId;
 
-		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback));
+		auto handler = std::make_shared<JCHandler>(request.transaction.value(), wrapAsyncCallback(callback), TransactionKind::HANGUP);
 
-		std::string data = request.toJsonStr();
+		_transport->send(toJsonBuffer(request), handler);
+	}
 
-		_transport->send(data, handler);
+	void JanusApiClient::replayPending()
+	{
+		_transport->replayPending();
+	}
+
+	void JanusApiClient::resume()
+	{
+		_transport->resume();
 	}
 
 	void JanusApiClient::onOpened()
@@ -277,11 +285,11 @@ namespace vi {
 		});
 	}
 
-	void JanusApiClient::onMessage(const std::string& json)
+	void JanusApiClient::onMessage(std::shared_ptr<const JanusMessage> message)
 	{
-		UniversalObservable<ISfuApiClientListener>::notifyObservers([wself = weak_from_this(), json](const auto& observer) {
+		UniversalObservable<ISfuApiClientListener>::notifyObservers([wself = weak_from_this(), message](const auto& observer) {
 			if (auto self = wself.lock()) {
-				observer->onMessage(json);
+				observer->onMessage(message);
 			}
 		});
 	}
@@ -291,7 +299,7 @@ namespace vi {
 		auto lambda = [wself = weak_from_this(), callback](const std::string& json) {
 			if (auto self = wself.lock()) {
 				if (callback) {
-					TMgr->thread(self->_callbackThreadName)->PostTask(RTC_FROM_HERE, [wself, callback, json]() {
+					self->_callbackThread->PostTask(RTC_FROM_HERE, [wself, callback, json]() {
 						if (auto self = wself.lock()) {
 							if (callback) {
 								(*callback)(json);
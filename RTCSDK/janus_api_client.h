@@ -19,6 +19,7 @@ namespace rtc {
 
 namespace vi {
 	class IMessageTransportor;
+	class ThreadProvider;
 	class JanusApiClient
 		: public ISfuApiClient
 		, public IMessageTransportListener
@@ -26,7 +27,11 @@ namespace vi {
 		, public std::enable_shared_from_this<JanusApiClient>
 	{
 	public:
-		JanusApiClient(const std::string& callbackThreadName);
+		// Listeners are called in |callbackThreadName| of |threads|, the transport runs in its "message-transport".
+		JanusApiClient(std::shared_ptr<ThreadProvider> threads, const std::string& callbackThreadName);
+
+		// Websocket transports run on |websocket|, which other clients may share (see WebsocketEndpoint::shared()).
+		JanusApiClient(std::shared_ptr<ThreadProvider> threads, const std::string& callbackThreadName, std::shared_ptr<WebsocketEndpoint> websocket);
 
 		~JanusApiClient() override;
 
@@ -55,12 +60,18 @@ namespace vi {
 
 		void detach(int64_t sessionId, int64_t handleId, std::shared_ptr<JCCallback> callback) override;
 
-		void sendMessage(int64_t sessionId, int64_t handleId, const std::string& message, const std::string& jsep, std::shared_ptr<JCCallback> callback) override;
+		void sendMessage(int64_t sessionId, int64_t handleId, const std::string& message, const std::string& jsep, const std::string& coalesceKey, std::shared_ptr<JCCallback> callback) override;
 
 		void sendTrickleCandidate(int64_t sessionId, int64_t handleId, const CandidateData& candidate, std::shared_ptr<JCCallback> callback) override;
 
+		void sendTrickleCandidates(int64_t sessionId, int64_t handleId, const std::vector<CandidateData>& candidates, std::shared_ptr<JCCallback> callback) override;
+
 		void hangup(int64_t sessionId, int64_t handleId, std::shared_ptr<JCCallback> callback) override;
 
+		void replayPending() override;
+
+		void resume() override;
+
 	protected:
 		// IMessageTransportListener
 		void onOpened() override;
@@ -69,16 +80,19 @@ namespace vi {
 
 		void onFailed(int errorCode, const std::string& reason) override;
 
-		void onMessage(const std::string& json) override;
+		void onMessage(std::shared_ptr<const JanusMessage> message) override;
 
 	private:
 		std::shared_ptr<JCCallback> wrapAsyncCallback(std::shared_ptr<JCCallback> callback);
 
 	private:
-		std::string _callbackThreadName;
+		rtc::Thread* _callbackThread = nullptr;
+		rtc::Thread* _transportThread = nullptr;
 		std::string _url;
 		std::string _token;
 		std::string _apisecret;
+		std::shared_ptr<WebsocketEndpoint> _websocket;
 		std::shared_ptr<IMessageTransport> _transport;
+		bool _unixSocket = false;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,88 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#include "janus_message.h"
+#include "logger/logger.h"
+
+namespace vi {
+	namespace {
+		// |unpublished| and |leaving| can be int or string, replace string 'ok' to 0
+		// TODO: remove workaround
+		void replaceOkTag(std::string& data, const std::string& key)
+		{
+			const std::string tag("\"" + key + "\": \"ok\"");
+			size_t pos = data.find(tag);
+			if (pos != std::string::npos) {
+				data.replace(pos, tag.length(), "\"" + key + "\": 0");
+			}
+		}
+	}
+
+	JanusMessage::JanusMessage(std::string&& raw)
+		: _raw(std::move(raw))
+	{
+
+	}
+
+	JanusMessage::~JanusMessage()
+	{
+
+	}
+
+	std::shared_ptr<JanusMessage> JanusMessage::create(const std::string& json, std::string& error)
+	{
+		std::string data = json;
+		replaceOkTag(data, "unpublished");
+		replaceOkTag(data, "leaving");
+
+		std::shared_ptr<JanusMessage> message(new JanusMessage(std::move(data)));
+
+		auto& doc = message->_document;
+		doc.Parse(message->_raw.c_str(), message->_raw.size());
+		if (doc.HasParseError()) {
+			error = "parse error: " + std::to_string(doc.GetParseError()) + " at offset " + std::to_string(doc.GetErrorOffset());
+			return nullptr;
+		}
+
+		if (!doc.IsObject()) {
+			error = "message is not an object";
+			return nullptr;
+		}
+
+		auto it = doc.FindMember("janus");
+		if (it != doc.MemberEnd() && it->value.IsString()) {
+			message->_janus.assign(it->value.GetString(), it->value.GetStringLength());
+		}
+
+		it = doc.FindMember("transaction");
+		if (it != doc.MemberEnd() && it->value.IsString()) {
+			message->_transaction.assign(it->value.GetString(), it->value.GetStringLength());
+		}
+
+		it = doc.FindMember("sender");
+		if (it != doc.MemberEnd() && it->value.IsInt64()) {
+			message->_sender = it->value.GetInt64();
+		}
+
+		it = doc.FindMember("session_id");
+		if (it != doc.MemberEnd() && it->value.IsInt64()) {
+			message->_sessionId = it->value.GetInt64();
+		}
+
+		return message;
+	}
+
+	bool JanusMessage::hasMember(const char* name) const
+	{
+		auto it = _document.FindMember(name);
+		return it != _document.MemberEnd() && !it->value.IsNull();
+	}
+
+	void JanusMessage::onViewError(const std::string& key, const std::string& error) const
+	{
+		DLOG("materialize view {} failed: {}", key, error);
+	}
+}
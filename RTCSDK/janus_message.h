@@ -0,0 +1,121 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <typeinfo>
+#include <unordered_map>
+#include "json/serialization_json.hpp"
+
+namespace vi {
+	// An inbound Janus message decoded exactly once at the transport. The document is
+	// immutable after creation, typed models are materialized lazily from the DOM and cached,
+	// so every layer (signaling client, plugin clients, video room) shares the same parse.
+	class JanusMessage
+	{
+	public:
+		// Returns nullptr and fills |error| if |json| could not be parsed.
+		static std::shared_ptr<JanusMessage> create(const std::string& json, std::string& error);
+
+		~JanusMessage();
+
+		const std::string& raw() const { return _raw; }
+
+		const rapidjson::Document& document() const { return _document; }
+
+		const std::string& janus() const { return _janus; }
+
+		const std::string& transaction() const { return _transaction; }
+
+		bool hasSender() const { return _sender != -1; }
+
+		int64_t sender() const { return _sender; }
+
+		// -1 if the message does not name a session
+		int64_t sessionId() const { return _sessionId; }
+
+		bool hasMember(const char* name) const;
+
+		// Typed view over the whole message, e.g. view<vr::VideoRoomEvent>().
+		template<typename Type>
+		std::shared_ptr<const Type> view() const
+		{
+			return materialize<Type>(nullptr);
+		}
+
+		// Typed view over a top-level member, e.g. view<Jsep>("jsep").
+		template<typename Type>
+		std::shared_ptr<const Type> view(const char* member) const
+		{
+			return materialize<Type>(member);
+		}
+
+	private:
+		JanusMessage(std::string&& raw);
+
+		template<typename Type>
+		std::shared_ptr<const Type> materialize(const char* member) const
+		{
+			std::string key(typeid(Type).name());
+			if (member) {
+				key.append("/").append(member);
+			}
+
+			std::lock_guard<std::mutex> locker(_viewsMutex);
+			auto it = _views.find(key);
+			if (it != _views.end()) {
+				return std::static_pointer_cast<const Type>(it->second);
+			}
+
+			const rapidjson::Value* value = &_document;
+			if (member) {
+				auto mit = _document.FindMember(member);
+				if (mit == _document.MemberEnd() || !mit->value.IsObject()) {
+					return nullptr;
+				}
+				value = &mit->value;
+			}
+
+			auto model = std::make_shared<Type>();
+			try {
+				model->jdeserialize(*value);
+			}
+			catch (const JsonMissingKey& e) {
+				onViewError(key, e.what());
+				return nullptr;
+			}
+			catch (const JsonTypeMismatch& e) {
+				onViewError(key, e.what());
+				return nullptr;
+			}
+
+			_views[key] = model;
+			return model;
+		}
+
+		void onViewError(const std::string& key, const std::string& error) const;
+
+	private:
+		std::string _raw;
+
+		rapidjson::Document _document;
+
+		std::string _janus;
+
+		std::string _transaction;
+
+		int64_t _sender = -1;
+
+		int64_t _sessionId = -1;
+
+		mutable std::mutex _viewsMutex;
+
+		mutable std::unordered_map<std::string, std::shared_ptr<const void>> _views;
+	};
+}
@@ -4,19 +4,24 @@
 #include <memory>
 #include "absl/types/optional.h"
 #include "serialization_json.hpp"
+#include "serialization_json_sax.hpp"
+#include "serialization_json_writer.hpp"
 
 #define FIELDS_MAP(...)   \
 JSON_SERIALIZE(__VA_ARGS__) \
+JSON_SAX_DESERIALIZE(__VA_ARGS__) \
+JSON_WRITE(__VA_ARGS__) \
 MODEL_2_STRING()  \
 STRING_2_MODEL()
 
 
 #define FIELDS_MAP_NO_DSERIALIZE(...)   \
 JSON_NO_DSERIALIZE(__VA_ARGS__) \
+JSON_WRITE(__VA_ARGS__) \
 MODEL_2_STRING()  \
 STRING_2_MODEL()
 
-#define MODEL_2_STRING() virtual std::string toJsonStr() { return toJsonString(*this); }
+#define MODEL_2_STRING() virtual std::string toJsonStr() { return toJsonStringFast(*this); }
 #define STRING_2_MODEL() virtual rapidjson::Document toJsonOject() { return toJson(*this); }
 
 namespace vi {
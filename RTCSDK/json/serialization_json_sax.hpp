@@ -0,0 +1,479 @@
+/*
+    Exception-free decoding backend for the models declared with FIELDS_MAP.
+
+    The DOM backend in serialization_json.hpp builds a rapidjson::Document first and
+    throws JsonMissingKey/JsonTypeMismatch on errors. This backend pulls tokens from
+    rapidjson's iterative (SAX) reader and writes them straight into the struct fields,
+    errors are reported through JsonSaxResult instead of exceptions.
+
+    Example:
+
+    JanusResponse response;
+    auto result = fromJsonStringSax(data, response);
+    if (!result.ok()) {
+        DLOG("decode failed, status: {}, key: {}", (int)result.status, result.key);
+    }
+
+    Semantics follow the DOM backend: missing optionals and vectors/maps of models are left
+    empty, null optionals stay empty, any other missing member (vectors/maps of native values
+    included) reports MISSING_KEY. Anything but whitespace after the document is a PARSE_ERROR.
+    Unlike the DOM backend, integral json numbers are accepted for double/float members.
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include <type_traits>
+#include "absl/types/optional.h"
+#include <rapidjson/reader.h>
+#include "serialization_json.hpp"
+
+enum class JsonSaxStatus : uint32_t {
+    OK = 0,
+    PARSE_ERROR,
+    TYPE_MISMATCH,
+    MISSING_KEY
+};
+
+struct JsonSaxResult {
+    JsonSaxStatus status = JsonSaxStatus::OK;
+    // name of the offending member as declared in FIELDS_MAP, empty if unknown
+    const char* key = "";
+
+    bool ok() const { return status == JsonSaxStatus::OK; }
+};
+
+namespace rapidjson {
+
+// Pull-style wrapper around Reader::IterativeParseNext, parses in situ over its own copy
+// of the input so that keys and strings can be consumed without extra allocations.
+class JsonPullReader {
+public:
+    explicit JsonPullReader(const std::string& data)
+        : _buffer(data.c_str(), data.c_str() + data.size() + 1)
+        , _size(data.size())
+        , _stream(_buffer.data()) {
+        _reader.IterativeParseInit();
+        next();
+    }
+
+    JsonPullReader(const JsonPullReader&) = delete;
+    JsonPullReader& operator=(const JsonPullReader&) = delete;
+
+    // SAX handler
+    bool Null() { _token = kNull; return true; }
+    bool Bool(bool b) { _token = kBool; _bool = b; return true; }
+    bool Int(int i) { _token = kInt64; _int64 = i; return true; }
+    bool Uint(unsigned u) { _token = kInt64; _int64 = u; return true; }
+    bool Int64(int64_t i) { _token = kInt64; _int64 = i; return true; }
+    bool Uint64(uint64_t u) { _token = kUint64; _uint64 = u; return true; }
+    bool Double(double d) { _token = kDouble; _double = d; return true; }
+    bool RawNumber(const char*, SizeType, bool) { return false; }
+    bool String(const char* str, SizeType length, bool) { _token = kString; _string = str; _length = length; return true; }
+    bool StartObject() { _token = kStartObject; return true; }
+    bool Key(const char* str, SizeType length, bool) { _token = kKey; _string = str; _length = length; return true; }
+    bool EndObject(SizeType) { _token = kEndObject; return true; }
+    bool StartArray() { _token = kStartArray; return true; }
+    bool EndArray(SizeType) { _token = kEndArray; return true; }
+
+    const JsonSaxResult& result() const { return _result; }
+
+    bool ok() const { return _result.ok(); }
+
+    bool fail(JsonSaxStatus status, const char* key) {
+        if (_result.ok()) {
+            _result.status = status;
+            _result.key = key;
+        }
+        _token = kError;
+        return false;
+    }
+
+    bool isNull() const { return _token == kNull; }
+
+    // The document must be consumed, with nothing but whitespace after it.
+    bool finish() {
+        if (!ok()) {
+            return false;
+        }
+        if (_token != kEnd) {
+            return fail(JsonSaxStatus::PARSE_ERROR, "");
+        }
+        for (size_t i = _stream.Tell(); i < _size; ++i) {
+            const char c = _buffer[i];
+            if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+                return fail(JsonSaxStatus::PARSE_ERROR, "");
+            }
+        }
+        return true;
+    }
+
+    bool enterObject(const char* key) {
+        if (_token != kStartObject) {
+            return fail(JsonSaxStatus::TYPE_MISMATCH, key);
+        }
+        next();
+        return ok();
+    }
+
+    // Returns the next member name or nullptr at the end of the object (or on error).
+    const char* nextObjectKey() {
+        if (_token == kKey) {
+            const char* key = _string;
+            next();
+            return key;
+        }
+        if (_token == kEndObject) {
+            next();
+            return nullptr;
+        }
+        fail(JsonSaxStatus::PARSE_ERROR, "");
+        return nullptr;
+    }
+
+    bool enterArray(const char* key) {
+        if (_token != kStartArray) {
+            return fail(JsonSaxStatus::TYPE_MISMATCH, key);
+        }
+        next();
+        return ok();
+    }
+
+    bool nextArrayValue() {
+        if (_token == kEndArray) {
+            next();
+            return false;
+        }
+        if (_token == kError || _token == kEndObject || _token == kKey) {
+            fail(JsonSaxStatus::PARSE_ERROR, "");
+            return false;
+        }
+        return true;
+    }
+
+    bool getInt64(const char* key, int64_t& value) {
+        if (_token == kInt64) {
+            value = _int64;
+        }
+        else if (_token == kUint64 && _uint64 <= (uint64_t)INT64_MAX) {
+            value = (int64_t)_uint64;
+        }
+        else {
+            return fail(JsonSaxStatus::TYPE_MISMATCH, key);
+        }
+        next();
+        return ok();
+    }
+
+    bool getDouble(const char* key, double& value) {
+        if (_token == kDouble) {
+            value = _double;
+        }
+        else if (_token == kInt64) {
+            value = (double)_int64;
+        }
+        else if (_token == kUint64) {
+            value = (double)_uint64;
+        }
+        else {
+            return fail(JsonSaxStatus::TYPE_MISMATCH, key);
+        }
+        next();
+        return ok();
+    }
+
+    bool getBool(const char* key, bool& value) {
+        if (_token != kBool) {
+            return fail(JsonSaxStatus::TYPE_MISMATCH, key);
+        }
+        value = _bool;
+        next();
+        return ok();
+    }
+
+    bool getString(const char* key, std::string& value) {
+        if (_token != kString) {
+            return fail(JsonSaxStatus::TYPE_MISMATCH, key);
+        }
+        value.assign(_string, _length);
+        next();
+        return ok();
+    }
+
+    // Skips the current value, including nested objects and arrays.
+    void skipValue() {
+        int depth = 0;
+        do {
+            if (_token == kStartObject || _token == kStartArray) {
+                ++depth;
+            }
+            else if (_token == kEndObject || _token == kEndArray) {
+                --depth;
+            }
+            else if (_token == kError) {
+                return;
+            }
+            next();
+        } while (depth > 0);
+    }
+
+private:
+    void next() {
+        if (_token == kError) {
+            return;
+        }
+        if (_reader.IterativeParseComplete()) {
+            _token = kEnd;
+            return;
+        }
+        _reader.IterativeParseNext<kParseInsituFlag>(_stream, *this);
+        if (_reader.HasParseError()) {
+            fail(JsonSaxStatus::PARSE_ERROR, "");
+        }
+    }
+
+private:
+    enum Token {
+        kInit, kError, kEnd, kNull, kBool, kInt64, kUint64, kDouble, kString, kKey,
+        kStartObject, kEndObject, kStartArray, kEndArray
+    };
+
+    std::vector<char> _buffer;
+    size_t _size = 0;
+    InsituStringStream _stream;
+    Reader _reader;
+    JsonSaxResult _result;
+
+    Token _token = kInit;
+    bool _bool = false;
+    int64_t _int64 = 0;
+    uint64_t _uint64 = 0;
+    double _double = 0;
+    const char* _string = nullptr;
+    SizeType _length = 0;
+};
+
+//reader for customized types, generated by FIELDS_MAP
+template<typename Type, typename Enable = void>
+struct JsonSaxField {
+    static bool read(JsonPullReader& reader, const char* key, Type& value) {
+        return value.jsaxdeserialize(reader, key);
+    }
+};
+
+template<>
+struct JsonSaxField<int64_t> {
+    static bool read(JsonPullReader& reader, const char* key, int64_t& value) {
+        return reader.getInt64(key, value);
+    }
+};
+
+template<>
+struct JsonSaxField<int> {
+    static bool read(JsonPullReader& reader, const char* key, int& value) {
+        int64_t v = 0;
+        if (!reader.getInt64(key, v)) {
+            return false;
+        }
+        if (v < INT_MIN || v > INT_MAX) {
+            return reader.fail(JsonSaxStatus::TYPE_MISMATCH, key);
+        }
+        value = (int)v;
+        return true;
+    }
+};
+
+template<>
+struct JsonSaxField<double> {
+    static bool read(JsonPullReader& reader, const char* key, double& value) {
+        return reader.getDouble(key, value);
+    }
+};
+
+template<>
+struct JsonSaxField<float> {
+    static bool read(JsonPullReader& reader, const char* key, float& value) {
+        double v = 0;
+        if (!reader.getDouble(key, v)) {
+            return false;
+        }
+        value = (float)v;
+        return true;
+    }
+};
+
+template<>
+struct JsonSaxField<bool> {
+    static bool read(JsonPullReader& reader, const char* key, bool& value) {
+        return reader.getBool(key, value);
+    }
+};
+
+template<>
+struct JsonSaxField<std::string> {
+    static bool read(JsonPullReader& reader, const char* key, std::string& value) {
+        return reader.getString(key, value);
+    }
+};
+
+template<typename Type>
+struct JsonSaxField<Type, typename std::enable_if<std::is_enum<Type>::value>::type> {
+    static bool read(JsonPullReader& reader, const char* key, Type& value) {
+        int64_t v = 0;
+        if (!reader.getInt64(key, v)) {
+            return false;
+        }
+        value = (Type)v;
+        return true;
+    }
+};
+
+template<typename Type>
+struct JsonSaxField<absl::optional<Type>> {
+    static bool read(JsonPullReader& reader, const char* key, absl::optional<Type>& value) {
+        if (reader.isNull()) {
+            reader.skipValue();
+            return reader.ok();
+        }
+        Type v;
+        if (!JsonSaxField<Type>::read(reader, key, v)) {
+            return false;
+        }
+        value = std::move(v);
+        return true;
+    }
+};
+
+template<typename Type>
+struct JsonSaxField<std::vector<Type>> {
+    static bool read(JsonPullReader& reader, const char* key, std::vector<Type>& value) {
+        value.clear();
+        if (!reader.enterArray(key)) {
+            return false;
+        }
+        while (reader.nextArrayValue()) {
+            Type v;
+            if (!JsonSaxField<Type>::read(reader, key, v)) {
+                return false;
+            }
+            value.push_back(std::move(v));
+        }
+        return reader.ok();
+    }
+};
+
+template<typename Type>
+struct JsonSaxField<std::map<std::string, Type>> {
+    static bool read(JsonPullReader& reader, const char* key, std::map<std::string, Type>& value) {
+        value.clear();
+        if (!reader.enterObject(key)) {
+            return false;
+        }
+        while (const char* k = reader.nextObjectKey()) {
+            Type v;
+            if (!JsonSaxField<Type>::read(reader, key, v)) {
+                return false;
+            }
+            value[k] = std::move(v);
+        }
+        return reader.ok();
+    }
+};
+
+//members that may be absent without an error, the same rule as the DOM backend: containers of
+//native values go through JsonSerializerPod there, which throws JsonMissingKey
+template<typename Type>
+struct is_sax_optional_member {
+    static const bool value = false;
+};
+template<typename Type>
+struct is_sax_optional_member<absl::optional<Type>> {
+    static const bool value = true;
+};
+template<typename Type>
+struct is_sax_optional_member<std::vector<Type>> {
+    static const bool value = !is_native_type<Type>::value;
+};
+template<typename Type>
+struct is_sax_optional_member<std::map<std::string, Type>> {
+    static const bool value = !is_native_type<Type>::value;
+};
+
+//dispatches |key| to the matching member, returns false if no member matches
+template<typename Key, typename Type, typename... Tail>
+inline bool json_sax_field(JsonPullReader& reader, const char* key, uint64_t& seen, uint32_t index, const Key& name, Type& value, Tail& ... tail) {
+    if (0 == std::strcmp(key, name)) {
+        seen |= (uint64_t)1 << index;
+        JsonSaxField<Type>::read(reader, name, value);
+        return true;
+    }
+    return json_sax_field(reader, key, seen, index + 1, tail...);
+}
+
+//terminus
+inline bool json_sax_field(JsonPullReader& reader, const char* key, uint64_t& seen, uint32_t index) {
+    return false;
+}
+
+template<typename Key, typename Type, typename... Tail>
+inline bool json_sax_required(JsonPullReader& reader, uint64_t seen, uint32_t index, const Key& name, Type& value, Tail& ... tail) {
+    if (!is_sax_optional_member<Type>::value && 0 == (seen & ((uint64_t)1 << index))) {
+        return reader.fail(JsonSaxStatus::MISSING_KEY, name);
+    }
+    return json_sax_required(reader, seen, index + 1, tail...);
+}
+
+//terminus
+inline bool json_sax_required(JsonPullReader& reader, uint64_t seen, uint32_t index) {
+    return true;
+}
+
+template<typename... Fields>
+inline bool json_sax_deserialize(JsonPullReader& reader, const char* key, Fields& ... fields) {
+    static_assert(sizeof...(Fields) / 2 <= 64, "too many members for the sax decoder");
+    if (!reader.enterObject(key)) {
+        return false;
+    }
+    uint64_t seen = 0;
+    while (const char* k = reader.nextObjectKey()) {
+        if (!json_sax_field(reader, k, seen, 0, fields...)) {
+            reader.skipValue();
+        }
+        if (!reader.ok()) {
+            return false;
+        }
+    }
+    if (!reader.ok()) {
+        return false;
+    }
+    return json_sax_required(reader, seen, 0, fields...);
+}
+}
+
+//This macro declares the sax decoder for the members listed in FIELDS_MAP
+#define JSON_SAX_DESERIALIZE(...)\
+    bool jsaxdeserialize(rapidjson::JsonPullReader& jreader, const char* jkey = "")\
+                                {\
+        return rapidjson::json_sax_deserialize(jreader, jkey, __VA_ARGS__);\
+                                }
+
+template<typename Type>
+inline JsonSaxResult fromJsonStringSax(const std::string& data, Type& object) {
+    rapidjson::JsonPullReader reader(data);
+    if (object.jsaxdeserialize(reader)) {
+        reader.finish();
+    }
+    return reader.result();
+}
+
+template<typename Type>
+inline std::shared_ptr<Type> fromJsonStringSax(const std::string& data, JsonSaxResult& result) {
+    std::shared_ptr<Type> object = std::make_shared<Type>();
+    result = fromJsonStringSax(data, *object);
+    return object;
+}
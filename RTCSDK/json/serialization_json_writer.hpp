@@ -0,0 +1,226 @@
+/*
+    Streaming serialization for the models declared with FIELDS_MAP.
+
+    Instead of building a rapidjson::Document through jserialize() and stringifying it,
+    jwrite() emits the members straight into a rapidjson::Writer. The output goes to a
+    StringBuffer taken from a small thread-local pool, so steady-state serialization does
+    not allocate.
+
+    Example:
+
+    TrickleRequest request;
+    auto buffer = toJsonBuffer(request);
+    endpoint->sendText(id, buffer->GetString(), buffer->GetSize());
+    // the buffer goes back to the pool when |buffer| is released
+
+    Absent optionals are skipped, as in the DOM backend.
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include "absl/types/optional.h"
+#include <rapidjson/writer.h>
+#include <rapidjson/stringbuffer.h>
+
+using JsonBuffer = rapidjson::StringBuffer;
+
+using JsonBufferWriter = rapidjson::Writer<JsonBuffer>;
+
+// Returns buffers to the pool of the thread that releases them.
+struct JsonBufferRecycler {
+    void operator()(JsonBuffer* buffer) const;
+};
+
+using JsonBufferPtr = std::unique_ptr<JsonBuffer, JsonBufferRecycler>;
+
+class JsonBufferPool {
+public:
+    // buffers kept per thread
+    static const size_t kMaxPooledBuffers = 8;
+
+    // buffers grown above this (e.g. by an SDP) are shrunk before going back to the pool
+    static const size_t kMaxPooledCapacity = 64 * 1024;
+
+    static JsonBufferPtr acquire() {
+        auto& pool = buffers();
+        if (pool.empty()) {
+            return JsonBufferPtr(new JsonBuffer());
+        }
+        JsonBuffer* buffer = pool.back().release();
+        pool.pop_back();
+        return JsonBufferPtr(buffer);
+    }
+
+    static void recycle(JsonBuffer* buffer) {
+        auto& pool = buffers();
+        if (pool.size() >= kMaxPooledBuffers) {
+            delete buffer;
+            return;
+        }
+        buffer->Clear();
+        if (bufferCapacity(buffer) > kMaxPooledCapacity) {
+            buffer->ShrinkToFit();
+        }
+        pool.emplace_back(buffer);
+    }
+
+private:
+    static size_t bufferCapacity(JsonBuffer* buffer) {
+        return buffer->stack_.GetCapacity();
+    }
+
+    static std::vector<std::unique_ptr<JsonBuffer>>& buffers() {
+        static thread_local std::vector<std::unique_ptr<JsonBuffer>> pool;
+        return pool;
+    }
+};
+
+inline void JsonBufferRecycler::operator()(JsonBuffer* buffer) const {
+    JsonBufferPool::recycle(buffer);
+}
+
+namespace rapidjson {
+
+//writer for customized types, generated by FIELDS_MAP
+template<typename Type, typename Enable = void>
+struct JsonWriteValue {
+    template<typename Writer>
+    static void write(Writer& writer, const Type& value) {
+        value.jwrite(writer);
+    }
+};
+
+template<>
+struct JsonWriteValue<int64_t> {
+    template<typename Writer>
+    static void write(Writer& writer, int64_t value) { writer.Int64(value); }
+};
+
+template<>
+struct JsonWriteValue<int> {
+    template<typename Writer>
+    static void write(Writer& writer, int value) { writer.Int(value); }
+};
+
+template<>
+struct JsonWriteValue<double> {
+    template<typename Writer>
+    static void write(Writer& writer, double value) { writer.Double(value); }
+};
+
+template<>
+struct JsonWriteValue<float> {
+    template<typename Writer>
+    static void write(Writer& writer, float value) { writer.Double(value); }
+};
+
+template<>
+struct JsonWriteValue<bool> {
+    template<typename Writer>
+    static void write(Writer& writer, bool value) { writer.Bool(value); }
+};
+
+template<>
+struct JsonWriteValue<std::string> {
+    template<typename Writer>
+    static void write(Writer& writer, const std::string& value) {
+        writer.String(value.c_str(), (SizeType)value.size());
+    }
+};
+
+template<typename Type>
+struct JsonWriteValue<Type, typename std::enable_if<std::is_enum<Type>::value>::type> {
+    template<typename Writer>
+    static void write(Writer& writer, Type value) { writer.Int64((int64_t)value); }
+};
+
+template<typename Type>
+struct JsonWriteValue<std::vector<Type>> {
+    template<typename Writer>
+    static void write(Writer& writer, const std::vector<Type>& value) {
+        writer.StartArray();
+        for (const auto& item : value) {
+            JsonWriteValue<Type>::write(writer, item);
+        }
+        writer.EndArray();
+    }
+};
+
+template<typename Type>
+struct JsonWriteValue<std::map<std::string, Type>> {
+    template<typename Writer>
+    static void write(Writer& writer, const std::map<std::string, Type>& value) {
+        writer.StartObject();
+        for (const auto& pair : value) {
+            writer.Key(pair.first.c_str(), (SizeType)pair.first.size());
+            JsonWriteValue<Type>::write(writer, pair.second);
+        }
+        writer.EndObject();
+    }
+};
+
+template<typename Type>
+struct JsonWriteField {
+    template<typename Writer>
+    static void write(Writer& writer, const char* name, const Type& value) {
+        writer.Key(name);
+        JsonWriteValue<Type>::write(writer, value);
+    }
+};
+
+template<typename Type>
+struct JsonWriteField<absl::optional<Type>> {
+    template<typename Writer>
+    static void write(Writer& writer, const char* name, const absl::optional<Type>& value) {
+        if (value) {
+            writer.Key(name);
+            JsonWriteValue<Type>::write(writer, *value);
+        }
+    }
+};
+
+template<typename Writer, typename Key, typename Type, typename... Tail>
+inline void json_write(Writer& writer, const Key& name, const Type& value, const Tail& ... tail) {
+    JsonWriteField<Type>::write(writer, name, value);
+    json_write(writer, tail...);
+}
+
+//terminus
+template<typename Writer>
+inline void json_write(Writer& writer) {
+}
+}
+
+//This macro declares the streaming writer for the members listed in FIELDS_MAP,
+//jwriteMembers() lets callers append extra members (e.g. pre-serialized bodies) to the object.
+#define JSON_WRITE(...)\
+    template<typename Writer>\
+    void jwriteMembers(Writer& jwriter) const\
+                                {\
+        rapidjson::json_write(jwriter, __VA_ARGS__);\
+                                }\
+    template<typename Writer>\
+    void jwrite(Writer& jwriter) const\
+                                {\
+        jwriter.StartObject();\
+        jwriteMembers(jwriter);\
+        jwriter.EndObject();\
+                                }
+
+template<typename Type>
+inline JsonBufferPtr toJsonBuffer(const Type& value) {
+    JsonBufferPtr buffer = JsonBufferPool::acquire();
+    JsonBufferWriter writer(*buffer);
+    value.jwrite(writer);
+    return buffer;
+}
+
+template<typename Type>
+inline std::string toJsonStringFast(const Type& value) {
+    JsonBufferPtr buffer = toJsonBuffer(value);
+    return std::string(buffer->GetString(), buffer->GetSize());
+}
@@ -1,14 +1,18 @@
 #include "media_controller.h"
+#include <algorithm>
 #include "api/media_stream_interface.h"
 #include "pc/media_stream.h"
 #include "pc/media_stream_proxy.h"
 #include "video_room_client.h"
 #include "video_room_api.h"
+#include "helper_utils.h"
+#include "video_room_subscriber.h"
 #include "logger/logger.h"
 
 namespace vi {
-	MediaController::MediaController(std::shared_ptr<VideoRoomClient> vrc)
+	MediaController::MediaController(std::shared_ptr<VideoRoomClient> vrc, rtc::Thread* eventHandlerThread)
 		: _vrc(vrc)
+		, _eventHandlerThread(eventHandlerThread)
 	{
 
 	}
@@ -30,7 +34,7 @@ namespace vi {
 
 	void MediaController::registerEventHandler(std::shared_ptr<IMediaControlEventHandler> handler) 
 	{
-		UniversalObservable<IMediaControlEventHandler>::addWeakObserver(handler, std::string("main"));
+		UniversalObservable<IMediaControlEventHandler>::addWeakObserver(handler, _eventHandlerThread);
 	}
 
 	void MediaController::unregisterEventHandler(std::shared_ptr<IMediaControlEventHandler> handler) 
@@ -109,6 +113,70 @@ namespace vi {
 		return false;
 	}
 
+	void MediaController::setVideoLayer(const VideoLayer& layer)
+	{
+		auto sender = localVideoSender();
+		if (!sender) {
+			DLOG("No video sender");
+			return;
+		}
+
+		webrtc::RtpParameters params = sender->GetParameters();
+		auto it = std::find_if(params.encodings.begin(), params.encodings.end(), [&layer](const webrtc::RtpEncodingParameters& encoding) {
+			return encoding.rid == layer.rid;
+		});
+		if (it == params.encodings.end() && layer.rid.empty() && params.encodings.size() == 1) {
+			it = params.encodings.begin();
+		}
+		if (it == params.encodings.end()) {
+			DLOG("No video layer with rid: {}", layer.rid);
+			return;
+		}
+
+		HelperUtils::updateRtpEncoding(layer, *it);
+		webrtc::RTCError result = sender->SetParameters(params);
+		if (!result.ok()) {
+			DLOG("set video layer {} error message: {}", layer.rid, result.message());
+		}
+	}
+
+	std::vector<VideoLayer> MediaController::videoLayers()
+	{
+		std::vector<VideoLayer> layers;
+		if (auto sender = localVideoSender()) {
+			for (const auto& encoding : sender->GetParameters().encodings) {
+				layers.emplace_back(HelperUtils::toVideoLayer(encoding));
+			}
+		}
+		return layers;
+	}
+
+	void MediaController::setRemoteViewSize(const std::string& mid, int width, int height)
+	{
+		auto vrc = _vrc.lock();
+		if (!vrc) {
+			DLOG("Invalid vrc");
+			return;
+		}
+
+		if (auto subscriber = vrc->subscriber()) {
+			subscriber->setViewSize(mid, width, height);
+		}
+	}
+
+	void MediaController::setRemoteViewVisible(const std::string& mid, bool visible)
+	{
+		auto vrc = _vrc.lock();
+		if (!vrc) {
+			DLOG("Invalid vrc");
+			return;
+		}
+
+		if (auto subscriber = vrc->subscriber()) {
+			subscriber->setViewVisible(mid, visible);
+		}
+	}
+
 	void MediaController::onWebrtcStatus(bool isActive, const std::string& reason)
 	{
 		UniversalObservable<IMediaControlEventHandler>::notifyObservers([isActive, reason](const auto& observer) {
@@ -276,6 +344,28 @@ namespace vi {
 
 		return false;
 	}
+
+	rtc::scoped_refptr<webrtc::RtpSenderInterface> MediaController::localVideoSender()
+	{
+		auto vrc = _vrc.lock();
+		if (!vrc) {
+			DLOG("Invalid vrc");
+			return nullptr;
+		}
+
+		const auto& context = vrc->pluginContext();
+		if (!context || !context->pc) {
+			DLOG("Invalid PeerConnection");
+			return nullptr;
+		}
+
+		for (const auto& sender : context->pc->GetSenders()) {
+			if (sender->media_type() == cricket::MediaType::MEDIA_TYPE_VIDEO && sender->track()) {
+				return sender;
+			}
+		}
+		return nullptr;
+	}
 }
 
 //if (!mid.empty() && _pluginContext->unifiedPlan) {
@@ -8,6 +8,7 @@
 namespace webrtc {
     class MediaStreamInterface;
     class MediaStreamTrackInterface;
+    class RtpSenderInterface;
 }
 
 namespace vi {
@@ -20,7 +21,8 @@ namespace vi {
         , public std::enable_shared_from_this<MediaController>
     {
     public:
-        MediaController(std::shared_ptr<VideoRoomClient> vrc);
+        // Event handlers are called in |eventHandlerThread|, the main thread of the engine.
+        MediaController(std::shared_ptr<VideoRoomClient> vrc, rtc::Thread* eventHandlerThread);
 
         ~MediaController();
 
@@ -48,6 +50,14 @@ namespace vi {
 
         bool isVideoMuted(int64_t pid) override;
 
+        void setVideoLayer(const VideoLayer& layer) override;
+
+        std::vector<VideoLayer> videoLayers() override;
+
+        void setRemoteViewSize(const std::string& mid, int width, int height) override;
+
+        void setRemoteViewVisible(const std::string& mid, bool visible) override;
+
         void onWebrtcStatus(bool isActive, const std::string& reason);
 
         void onLocalTrack(rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track, int64_t mid, bool on);
@@ -59,9 +69,13 @@ namespace vi {
 
         bool muteLocal(bool isVideo, bool mute);
 
+        rtc::scoped_refptr<webrtc::RtpSenderInterface> localVideoSender();
+
     private:
 
         std::weak_ptr<VideoRoomClient> _vrc;
+
+        rtc::Thread* _eventHandlerThread;
     };
 
 }
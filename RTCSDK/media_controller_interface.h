@@ -2,7 +2,9 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "weak_proxy.h"
+#include "video_layer.h"
 
 namespace vi {
 
@@ -36,21 +38,55 @@ namespace vi {
 		virtual void muteVideo(int64_t pid, const std::string& mid, bool mute) = 0;
 
 		virtual bool isVideoMuted(int64_t pid) = 0;
+
+		// Updates the published video layer with the rid of |layer|, or the only one if it has none,
+		// through RtpSender::SetParameters, so without renegotiation.
+		virtual void setVideoLayer(const VideoLayer& layer) = 0;
+
+		virtual std::vector<VideoLayer> videoLayers() = 0;
+
+		// Size in pixels of the view the remote video |mid| is rendered in, so that Janus forwards a
+		// substream that fits it. Sizes are debounced, report every resize.
+		virtual void setRemoteViewSize(const std::string& mid, int width, int height) = 0;
+
+		// Janus stops relaying the remote video |mid| while its view is hidden, minimized or off-screen.
+		// The renderer should drop its sink meanwhile too.
+		virtual void setRemoteViewVisible(const std::string& mid, bool visible) = 0;
+
+		// Non-blocking queries, the proxy answers them from its thread
+		virtual ProxyFuture<bool> isLocalAudioMutedAsync() { return ProxyFuture<bool>::ready(isLocalAudioMuted()); }
+
+		virtual ProxyFuture<bool> isLocalVideoMutedAsync() { return ProxyFuture<bool>::ready(isLocalVideoMuted()); }
+
+		virtual ProxyFuture<bool> isAudioMutedAsync(int64_t pid) { return ProxyFuture<bool>::ready(isAudioMuted(pid)); }
+
+		virtual ProxyFuture<bool> isVideoMutedAsync(int64_t pid) { return ProxyFuture<bool>::ready(isVideoMuted(pid)); }
+
+		virtual ProxyFuture<std::vector<VideoLayer>> videoLayersAsync() { return ProxyFuture<std::vector<VideoLayer>>::ready(videoLayers()); }
     };
 
 	BEGIN_WEAK_PROXY_MAP(MediaController)
 		WEAK_PROXY_THREAD_DESTRUCTOR()
-		WEAK_PROXY_METHOD0(void, init)
-		WEAK_PROXY_METHOD0(void, destroy)
-		WEAK_PROXY_METHOD1(void, registerEventHandler, std::shared_ptr<IMediaControlEventHandler>)
-		WEAK_PROXY_METHOD1(void, unregisterEventHandler, std::shared_ptr<IMediaControlEventHandler>)
-		WEAK_PROXY_METHOD1(void, muteLocalAudio, bool)
+		WEAK_PROXY_ASYNC_METHOD0(init)
+		WEAK_PROXY_ASYNC_METHOD0(destroy)
+		WEAK_PROXY_ASYNC_METHOD1(registerEventHandler, std::shared_ptr<IMediaControlEventHandler>)
+		WEAK_PROXY_ASYNC_METHOD1(unregisterEventHandler, std::shared_ptr<IMediaControlEventHandler>)
+		WEAK_PROXY_ASYNC_METHOD1(muteLocalAudio, bool)
 		WEAK_PROXY_METHOD0(bool, isLocalAudioMuted)
-		WEAK_PROXY_METHOD1(void, muteLocalVideo, bool)
+		WEAK_PROXY_ASYNC_METHOD1(muteLocalVideo, bool)
 		WEAK_PROXY_METHOD0(bool, isLocalVideoMuted)
-		WEAK_PROXY_METHOD3(void, muteAudio, int64_t, const std::string&, bool)
+		WEAK_PROXY_ASYNC_METHOD3(muteAudio, int64_t, const std::string&, bool)
 		WEAK_PROXY_METHOD1(bool, isAudioMuted, int64_t)
-		WEAK_PROXY_METHOD3(void, muteVideo, int64_t, const std::string&, bool)
+		WEAK_PROXY_ASYNC_METHOD3(muteVideo, int64_t, const std::string&, bool)
 		WEAK_PROXY_METHOD1(bool, isVideoMuted, int64_t)
+		WEAK_PROXY_ASYNC_METHOD1(setVideoLayer, const VideoLayer&)
+		WEAK_PROXY_METHOD0(std::vector<VideoLayer>, videoLayers)
+		WEAK_PROXY_ASYNC_METHOD3(setRemoteViewSize, const std::string&, int, int)
+		WEAK_PROXY_ASYNC_METHOD2(setRemoteViewVisible, const std::string&, bool)
+		WEAK_PROXY_FUTURE_METHOD0(bool, isLocalAudioMuted)
+		WEAK_PROXY_FUTURE_METHOD0(bool, isLocalVideoMuted)
+		WEAK_PROXY_FUTURE_METHOD1(bool, isAudioMuted, int64_t)
+		WEAK_PROXY_FUTURE_METHOD1(bool, isVideoMuted, int64_t)
+		WEAK_PROXY_FUTURE_METHOD0(std::vector<VideoLayer>, videoLayers)
 	END_WEAK_PROXY_MAP()
 }
\ No newline at end of file
@@ -22,13 +22,22 @@ namespace vi {
 		FIELDS_MAP("janus", janus, "token", token, "apisecret", apisecret, "transaction", transaction);
 	};
 
+	struct JanusError {
+		absl::optional<int64_t> code;
+		absl::optional<std::string> reason;
+
+		FIELDS_MAP("code", code, "reason", reason);
+	};
+
 	struct JanusResponse {
 		absl::optional<std::string> janus;
 		absl::optional<std::string> transaction;		
 		absl::optional<int64_t> session_id;
 		absl::optional<int64_t> sender;
+		// set if janus is "error"
+		absl::optional<JanusError> error;
 		
-		FIELDS_MAP("janus", janus, "transaction", transaction, "session_id", session_id, "sender", sender);
+		FIELDS_MAP("janus", janus, "transaction", transaction, "session_id", session_id, "sender", sender, "error", error);
 	};
 
 	struct Jsep {
@@ -38,13 +47,6 @@ namespace vi {
 		FIELDS_MAP("type", type, "sdp", sdp);
 	};
 
-	struct JanusError {
-		absl::optional<int64_t> code;
-		absl::optional<std::string> reason;
-
-		FIELDS_MAP("code", code, "reason", reason);
-	};
-
 	struct JanusData {
 		absl::optional<std::string> videoroom;
 
@@ -217,8 +219,9 @@ namespace vi {
 		absl::optional<int64_t> session_id;
 		absl::optional<int64_t> handle_id;
 		absl::optional<CandidateData> candidate;
+		absl::optional<std::vector<CandidateData>> candidates;
 		
-		FIELDS_MAP("janus", janus, "token", token, "apisecret", apisecret, "transaction", transaction, "session_id", session_id, "handle_id", handle_id, "candidate", candidate);
+		FIELDS_MAP("janus", janus, "token", token, "apisecret", apisecret, "transaction", transaction, "session_id", session_id, "handle_id", handle_id, "candidate", candidate, "candidates", candidates);
 	};
 
 	struct TrickleResponse {
@@ -6,17 +6,36 @@
 
 #include "message_transport.h"
 #include <iostream>
+#include <cstring>
 #include "websocket/i_connection_listener.h"
 #include "websocket/websocket_endpoint.h"
 #include "i_message_transport_listener.h"
 #include "logger/logger.h"
-#include "message_models.h"
-#include "json/serialization_json.hpp"
+#include "janus_message.h"
+#include "transaction_manager.h"
+#include "utils/thread_provider.h"
 
 namespace vi {
-	MessageTransport::MessageTransport()
+	namespace {
+		// stop draining the send queue while the socket holds more than this
+		const size_t kSendHighWatermark = 256 * 1024;
+
+		// retry interval while the socket is above the watermark
+		const uint32_t kSendBackoffMs = 5;
+
+		// answers a request that is not sent with the synthesized error, nobody waits for it forever
+		void reject(const std::shared_ptr<JCHandler>& handler, const std::string& reason)
+		{
+			if (handler && handler->valid()) {
+				(*handler->callback)(TransactionManager::errorResponse(handler->transaction, TransactionManager::kRejectedErrorCode, reason));
+			}
+		}
+	}
+
+	MessageTransport::MessageTransport(rtc::Thread* thread, std::shared_ptr<WebsocketEndpoint> websocket)
+		: _websocket(websocket)
+		, _thread(thread)
 	{
-		_websocket = std::make_shared<WebsocketEndpoint>();
 	}
 
 	MessageTransport::~MessageTransport()
@@ -26,12 +45,24 @@ namespace vi {
 
 	void MessageTransport::init()
 	{
-
+		if (!_transactions) {
+			_transactions = std::make_shared<TransactionManager>();
+			_transactions->start();
+		}
 	}
 
 	void MessageTransport::destroy()
 	{
+		std::vector<SendQueue::Item> dropped;
+		_sendQueue.clear(dropped);
+		for (const auto& item : dropped) {
+			reject(item.handler, "Transport destroyed");
+		}
 
+		if (_transactions) {
+			_transactions->stop();
+			_transactions->failAll("Transport destroyed");
+		}
 	}
 
 	bool MessageTransport::isValid()
@@ -42,10 +73,57 @@ namespace vi {
 		return false;
 	}
 
+	bool MessageTransport::openConnection(const std::string& url)
+	{
+		if (!_websocket) {
+			_websocket = std::make_shared<WebsocketEndpoint>();
+		}
+		_connectionId = _websocket->connect(url, shared_from_this(), "janus-protocol");
+		if (_connectionId == -1) {
+			// e.g. the url did not resolve, reported like an asynchronous failure so that a reconnect is scheduled again
+			onFail(-1, "connect failed");
+			return false;
+		}
+		return true;
+	}
+
+	void MessageTransport::closeConnection()
+	{
+		if (isValid()) {
+			_websocket->close(_connectionId, websocketpp::close::status::normal, "");
+		}
+	}
+
+	bool MessageTransport::writeText(const char* data, size_t size)
+	{
+		if (!isValid()) {
+			return false;
+		}
+		_websocket->sendText(_connectionId, data, size);
+		return true;
+	}
+
+	size_t MessageTransport::bufferedAmount()
+	{
+		return isValid() ? _websocket->bufferedAmount(_connectionId) : 0;
+	}
+
+	bool MessageTransport::track(std::shared_ptr<JCHandler> handler)
+	{
+		if (!handler || !handler->valid()) {
+			return true;
+		}
+		if (_transactions && _transactions->add(handler)) {
+			return true;
+		}
+		(*handler->callback)(TransactionManager::errorResponse(handler->transaction, TransactionManager::kRejectedErrorCode, "Too many pending transactions"));
+		return false;
+	}
+
 	// IMessageTransportor
 	void MessageTransport::addListener(std::shared_ptr<IMessageTransportListener> listener)
 	{
-		UniversalObservable<IMessageTransportListener>::addWeakObserver(listener, "message-transport");
+		UniversalObservable<IMessageTransportListener>::addWeakObserver(listener, _thread);
 	}
 
 	void MessageTransport::removeListener(std::shared_ptr<IMessageTransportListener> listener)
@@ -55,46 +133,194 @@ namespace vi {
 
 	void MessageTransport::connect(const std::string& url)
 	{
+		std::lock_guard<std::mutex> locker(_connectMutex);
+		if ((_opened || _connecting) && _url == url) {
+			// already connecting or connected
+			return;
+		}
 		_url = url;
-		if (_websocket) {
-			_connectionId = _websocket->connect(_url, shared_from_this(), "janus-protocol");
+		_connecting = true;
+		if (!openConnection(_url)) {
+			_connecting = false;
 		}
 	}
 
 	void MessageTransport::disconnect()
 	{
-		if (isValid()) {
-			_websocket->close(_connectionId, websocketpp::close::status::normal, "");
-		}
+		closeConnection();
+	}
+
+	bool MessageTransport::isOpen()
+	{
+		return _opened;
 	}
 
 	void MessageTransport::send(const std::string& data, std::shared_ptr<JCHandler> handler)
 	{
-		if (isValid()) {
-			_websocket->sendText(_connectionId, data);
-			DLOG("sendText: {}", data.c_str());
-			if (handler->valid()) {
-				std::lock_guard<std::mutex> locker(_callbackMutex);
-				_callbacksMap[handler->transaction] = handler->callback;
-			}
+		if (!isValid()) {
+			reject(handler, "Transport not valid");
+			return;
 		}
+		SendQueue::Item item;
+		item.buffer = JsonBufferPool::acquire();
+		std::memcpy(item.buffer->Push(data.size()), data.data(), data.size());
+		item.handler = handler;
+		enqueue(std::move(item));
 	}
 
 	void MessageTransport::send(const std::vector<uint8_t>& data, std::shared_ptr<JCHandler> handler)
 	{
-		if (isValid()) {
+		// binary frames exist on websockets only
+		if (!isValid() || !_websocket) {
+			reject(handler, "Transport not valid");
+			return;
+		}
+		if (track(handler)) {
 			_websocket->sendBinary(_connectionId, data);
-			if (handler->valid()) {
-				std::lock_guard<std::mutex> locker(_callbackMutex);
-				_callbacksMap[handler->transaction] = handler->callback;
+		}
+	}
+
+	void MessageTransport::send(JsonBufferPtr data, std::shared_ptr<JCHandler> handler)
+	{
+		if (!isValid() || !data) {
+			reject(handler, data ? "Transport not valid" : "Empty request");
+			return;
+		}
+		SendQueue::Item item;
+		item.buffer = std::move(data);
+		item.handler = handler;
+		enqueue(std::move(item));
+	}
+
+	void MessageTransport::sendUrgent(JsonBufferPtr data, std::shared_ptr<JCHandler> handler)
+	{
+		if (!data) {
+			return;
+		}
+		SendQueue::Item item;
+		item.buffer = std::move(data);
+		item.handler = handler;
+		_thread->PostTask(RTC_FROM_HERE, [wself = weak_from_this(), item]() {
+			auto self = wself.lock();
+			if (!self) {
+				return;
+			}
+			if (!self->isValid() || !self->_opened) {
+				reject(item.handler, "Transport not open");
+				return;
+			}
+			if (self->track(item.handler)) {
+				self->write(item);
+			}
+		});
+	}
+
+	void MessageTransport::enqueue(SendQueue::Item item)
+	{
+		item.priority = item.handler ? SendQueue::priorityOf(item.handler->kind) : SendPriority::BULK;
+		_sendQueue.push(std::move(item));
+		scheduleDrain(0);
+	}
+
+	void MessageTransport::scheduleDrain(uint32_t delayMs)
+	{
+		if (_drainScheduled.exchange(true)) {
+			return;
+		}
+		auto task = [wself = weak_from_this()]() {
+			if (auto self = wself.lock()) {
+				self->drain();
+			}
+		};
+		if (delayMs > 0) {
+			_thread->PostDelayedTask(RTC_FROM_HERE, task, delayMs);
+		}
+		else {
+			_thread->PostTask(RTC_FROM_HERE, task);
+		}
+	}
+
+	void MessageTransport::drain()
+	{
+		_drainScheduled = false;
+		// requests sent while the socket is down wait here until it is open again and resumed
+		while (isValid() && _opened && !_held) {
+			if (bufferedAmount() >= kSendHighWatermark) {
+				// backpressure, let the socket catch up before handing it more
+				scheduleDrain(kSendBackoffMs);
+				return;
+			}
+
+			SendQueue::Item item;
+			if (!_sendQueue.pop(item)) {
+				return;
+			}
+			// registered only now, so the deadline does not include the time spent queued
+			if (!track(item.handler)) {
+				continue;
+			}
+			write(std::move(item));
+		}
+	}
+
+	void MessageTransport::write(SendQueue::Item item)
+	{
+		writeText(item.buffer->GetString(), item.buffer->GetSize());
+		DLOG("sendText: {}", item.buffer->GetString());
+		if (_transactions && item.handler && item.handler->valid()) {
+			// websocketpp copied the frame, keep the request for a replay after a reconnect
+			_transactions->retain(item.handler->transaction, std::move(item.buffer));
+		}
+	}
+
+	void MessageTransport::replayPending()
+	{
+		if (!_transactions) {
+			return;
+		}
+		auto pending = _transactions->takePending();
+		DLOG("replaying {} pending transaction(s)", pending.size());
+		for (auto& item : pending) {
+			// a stale keepalive is worthless, the caller sends a fresh one
+			if (!item.payload || item.handler->kind == TransactionKind::KEEPALIVE) {
+				(*item.handler->callback)(TransactionManager::errorResponse(item.handler->transaction, TransactionManager::kRejectedErrorCode, "Transport reconnected"));
+				continue;
 			}
+			SendQueue::Item queued;
+			queued.buffer = std::move(item.payload);
+			queued.handler = item.handler;
+			enqueue(std::move(queued));
 		}
 	}
 
+	void MessageTransport::resume()
+	{
+		_held = false;
+		scheduleDrain(0);
+	}
+
+	SendQueueStats MessageTransport::sendQueueStats()
+	{
+		return _sendQueue.stats();
+	}
+
+	LatencyHistogram::Snapshot MessageTransport::transactionLatency(TransactionKind kind)
+	{
+		return _transactions ? _transactions->latency(kind) : LatencyHistogram::Snapshot();
+	}
+
+	TransactionStats MessageTransport::transactionStats()
+	{
+		return _transactions ? _transactions->stats() : TransactionStats();
+	}
+
 	// IConnectionListener
 	void MessageTransport::onOpen()
 	{
 		DLOG("opened");
+		_opened = true;
+		_connecting = false;
+		scheduleDrain(0);
 
 		UniversalObservable<IMessageTransportListener>::notifyObservers([wself = weak_from_this()](const auto& observer) {
 			if (auto self = wself.lock()) {
@@ -106,6 +332,9 @@ namespace vi {
 	void MessageTransport::onFail(int errorCode, const std::string& reason)
 	{
 		DLOG("errorCode = {}, reason = {}", errorCode, reason.c_str());
+		_opened = false;
+		_connecting = false;
+		_held = true;
 
 		UniversalObservable<IMessageTransportListener>::notifyObservers([wself = weak_from_this(), errorCode, reason](const auto& observer) {
 			if (auto self = wself.lock()) {
@@ -117,6 +346,9 @@ namespace vi {
 	void MessageTransport::onClose(int closeCode, const std::string& reason)
 	{
 		DLOG("errorCode = {}, reaseon = {}", closeCode, reason.c_str());
+		_opened = false;
+		_connecting = false;
+		_held = true;
 
 		UniversalObservable<IMessageTransportListener>::notifyObservers([wself = weak_from_this()](const auto& observer) {
 			if (auto self = wself.lock()) {
@@ -135,60 +367,40 @@ namespace vi {
 	{
 		DLOG("json = {}", json.c_str());
 
-		// |unpublished| can be int or string, replace string 'ok' to 0
-		std::string data = json;
-
-		// TODO: remove workaround
-		std::string tag1("\"unpublished\": \"ok\"");
-		size_t pos = data.find(tag1);
-		if (pos != std::string::npos) {
-			data = data.replace(pos, tag1.length(), "\"unpublished\": 0");
-		}
-
-		std::string tag2("\"leaving\": \"ok\"");
-		pos = data.find(tag2);
-		if (pos != std::string::npos) {
-			data = data.replace(pos, tag2.length(), "\"leaving\": 0");
-		}
-
 		std::string err;
-		auto response = fromJsonString<JanusResponse>(data, err);
+		std::shared_ptr<const JanusMessage> message = JanusMessage::create(json, err);
 
-		if (!err.empty()) {
-			DLOG("parse JanusResponse failed");
+		if (!message) {
+			DLOG("parse JanusMessage failed: {}", err);
 			return;
 		}
 
-		if (!response->janus) {
+		if (message->janus().empty()) {
 			DLOG("could not find 'janus' in response");
 			return;
 		}
 
-		if (response->transaction && (response->janus.value_or("") == "ack"
-			|| response->janus.value_or("") == "success"
-			|| response->janus.value_or("") == "error"
-			|| response->janus.value_or("") == "server_info")) {
-			if (auto thread = TMgr->thread("message-transport")) {
-				TMgr->thread("message-transport")->PostTask(RTC_FROM_HERE, [wself = weak_from_this(), response, data]() {
-					if (auto self = wself.lock()) {
-						std::lock_guard<std::mutex> locker(self->_callbackMutex);
-						const std::string& transaction = response->transaction.value();
-						if (self->_callbacksMap.find(transaction) != self->_callbacksMap.end()) {
-							std::shared_ptr<JCCallback> callback = self->_callbacksMap[transaction];
-							if (callback) {
-								(*callback)(data);
-							}
-							self->_callbacksMap.erase(transaction);
-						}
-					}
-				});
-			}
-
+		const std::string& janus = message->janus();
+		if (!message->transaction().empty() && (janus == "ack"
+			|| janus == "success"
+			|| janus == "error"
+			|| janus == "server_info")) {
+			// completed on |_thread| like events are notified there, so responses and events of a handle
+			// keep the order of the socket on their way to the plugin-client thread
+			_thread->PostTask(RTC_FROM_HERE, [wself = weak_from_this(), message]() {
+				auto self = wself.lock();
+				if (!self || !self->_transactions) {
+					return;
+				}
+				if (!self->_transactions->complete(message->transaction(), message->raw())) {
+					DLOG("no pending transaction {}, it may have timed out", message->transaction());
+				}
+			});
 		}
 		else {
-			UniversalObservable<IMessageTransportListener>::notifyObservers([wself = weak_from_this(), data](const auto& observer) {
+			UniversalObservable<IMessageTransportListener>::notifyObservers([wself = weak_from_this(), message](const auto& observer) {
 				if (auto self = wself.lock()) {
-					observer->onMessage(data);
+					observer->onMessage(message);
 				}
 			});
 		}
@@ -8,13 +8,17 @@
 
 #include <memory>
 #include <thread>
+#include <atomic>
+#include <mutex>
 #include "i_message_transport.h"
-#include <unordered_map>
 #include "websocket/i_connection_listener.h"
 #include "websocket/websocket_endpoint.h"
 #include "utils/universal_observable.hpp"
+#include "send_queue.h"
 
 namespace vi {
+	class TransactionManager;
+
 	class MessageTransport
 		: public IMessageTransport
 		, public IConnectionListener
@@ -22,7 +26,10 @@ namespace vi {
 		, public std::enable_shared_from_this<MessageTransport>
 	{
 	public:
-		MessageTransport();
+		// Runs on |thread|, the "message-transport" thread of its engine. |websocket| may be shared
+		// by many transports (see WebsocketEndpoint::shared()), a dedicated endpoint is created on
+		// connect if it is null.
+		explicit MessageTransport(rtc::Thread* thread, std::shared_ptr<WebsocketEndpoint> websocket = nullptr);
 
 		~MessageTransport() override;
 
@@ -39,10 +46,26 @@ namespace vi {
 
 		void disconnect() override;
 
+		bool isOpen() override;
+
+		void replayPending() override;
+
+		void resume() override;
+
 		void send(const std::string& data, std::shared_ptr<JCHandler> handler) override;
 		
 		void send(const std::vector<uint8_t>& data, std::shared_ptr<JCHandler> handler) override;
 
+		void send(JsonBufferPtr data, std::shared_ptr<JCHandler> handler) override;
+
+		void sendUrgent(JsonBufferPtr data, std::shared_ptr<JCHandler> handler) override;
+
+		LatencyHistogram::Snapshot transactionLatency(TransactionKind kind) override;
+
+		TransactionStats transactionStats() override;
+
+		SendQueueStats sendQueueStats() override;
+
 	protected:
 		// IConnectionListener implement
 		void onOpen() override;
@@ -63,18 +86,58 @@ namespace vi {
 
 		void onPongTimeout(const std::string& text) override;
 
+	protected:
+		// The socket operations, a transport over another kind of socket overrides these and
+		// reports back through the IConnectionListener methods above.
+
+		// returns false if the connection could not be initiated, after reporting it through onFail()
+		virtual bool openConnection(const std::string& url);
+
+		virtual void closeConnection();
+
+		virtual bool writeText(const char* data, size_t size);
+
+		// bytes written but not yet sent on the socket
+		virtual size_t bufferedAmount();
+
+		virtual bool isValid();
+
 	private:
-		bool isValid();
+		// registers |handler| before its request goes out, fails the callback if the table is full
+		bool track(std::shared_ptr<JCHandler> handler);
+
+		void enqueue(SendQueue::Item item);
+
+		void scheduleDrain(uint32_t delayMs);
+
+		// should be called in message-transport thread
+		void drain();
+
+		// should be called in message-transport thread
+		void write(SendQueue::Item item);
 
 	private:
 		std::string _url;
 
+		std::mutex _connectMutex;
+
 		int _connectionId = -1;
 
+		std::atomic_bool _opened = false;
+
+		std::atomic_bool _connecting = false;
+
 		std::shared_ptr<WebsocketEndpoint> _websocket;
 
-		std::mutex _callbackMutex;
+		rtc::Thread* _thread = nullptr;
+
+		std::shared_ptr<TransactionManager> _transactions;
+
+		SendQueue _sendQueue;
+
+		std::atomic_bool _drainScheduled = false;
 
-		std::unordered_map<std::string, std::shared_ptr<JCCallback>> _callbacksMap;
+		// set when the connection drops, cleared by resume()
+		std::atomic_bool _held = false;
 	};
 }
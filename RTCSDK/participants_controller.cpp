@@ -2,7 +2,8 @@
 #include "participant.h"
 
 namespace vi {
-    ParticipantsContrller::ParticipantsContrller() {
+    ParticipantsContrller::ParticipantsContrller(rtc::Thread* eventHandlerThread)
+        : _eventHandlerThread(eventHandlerThread) {
 
     }
 
@@ -23,7 +24,7 @@ namespace vi {
 
     void ParticipantsContrller::registerEventHandler(std::shared_ptr<IParticipantsControlEventHandler> handler)
     {
-        UniversalObservable<IParticipantsControlEventHandler>::addWeakObserver(handler, std::string("main"));
+        UniversalObservable<IParticipantsControlEventHandler>::addWeakObserver(handler, _eventHandlerThread);
     }
 
     void ParticipantsContrller::unregisterEventHandler(std::shared_ptr<IParticipantsControlEventHandler> handler)
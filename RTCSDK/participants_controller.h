@@ -12,7 +12,8 @@ namespace vi {
         , public std::enable_shared_from_this<ParticipantsContrller>
     {
     public:
-        ParticipantsContrller();
+        // Event handlers are called in |eventHandlerThread|, the main thread of the engine.
+        explicit ParticipantsContrller(rtc::Thread* eventHandlerThread);
 
         ~ParticipantsContrller();
 
@@ -39,6 +40,8 @@ namespace vi {
     private:
 
         std::map<int64_t, std::shared_ptr<Participant>> _participantsMap;
+
+        rtc::Thread* _eventHandlerThread;
     };
 
 }
\ No newline at end of file
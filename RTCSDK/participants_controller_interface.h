@@ -27,16 +27,23 @@ namespace vi {
 		virtual std::vector<std::shared_ptr<Participant>> participantList() = 0;
 
 		virtual void kick(int64_t pid) = 0;
+
+		// Non-blocking queries, the proxy answers them from its thread
+		virtual ProxyFuture<std::shared_ptr<Participant>> participantAsync(int64_t pid) { return ProxyFuture<std::shared_ptr<Participant>>::ready(participant(pid)); }
+
+		virtual ProxyFuture<std::vector<std::shared_ptr<Participant>>> participantListAsync() { return ProxyFuture<std::vector<std::shared_ptr<Participant>>>::ready(participantList()); }
 	};
 
 	BEGIN_WEAK_PROXY_MAP(ParticipantsContrller)
 		WEAK_PROXY_THREAD_DESTRUCTOR()
-		WEAK_PROXY_METHOD0(void, init)
-		WEAK_PROXY_METHOD0(void, destroy)
-		WEAK_PROXY_METHOD1(void, registerEventHandler, std::shared_ptr<IParticipantsControlEventHandler>)
-		WEAK_PROXY_METHOD1(void, unregisterEventHandler, std::shared_ptr<IParticipantsControlEventHandler>)
+		WEAK_PROXY_ASYNC_METHOD0(init)
+		WEAK_PROXY_ASYNC_METHOD0(destroy)
+		WEAK_PROXY_ASYNC_METHOD1(registerEventHandler, std::shared_ptr<IParticipantsControlEventHandler>)
+		WEAK_PROXY_ASYNC_METHOD1(unregisterEventHandler, std::shared_ptr<IParticipantsControlEventHandler>)
 		WEAK_PROXY_METHOD1(std::shared_ptr<Participant>, participant, int64_t)
 		WEAK_PROXY_METHOD0(std::vector<std::shared_ptr<Participant>>, participantList)
-		WEAK_PROXY_METHOD1(void, kick, int64_t)
+		WEAK_PROXY_ASYNC_METHOD1(kick, int64_t)
+		WEAK_PROXY_FUTURE_METHOD1(std::shared_ptr<Participant>, participant, int64_t)
+		WEAK_PROXY_FUTURE_METHOD0(std::vector<std::shared_ptr<Participant>>, participantList)
 	END_WEAK_PROXY_MAP()
 }
\ No newline at end of file
@@ -28,15 +28,23 @@
 #include "utils/thread_provider.h"
 #include "utils/task_scheduler.h"
 #include "message_models.h"
+#include "janus_message.h"
 #include "utils/sdp_utils.h"
+#include "teardown_coordinator.h"
 #include "absl/types/optional.h"
 
 namespace vi {
-	PluginClient::PluginClient(std::shared_ptr<SignalingClientInterface> sc, rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> pcf)
+	PluginClient::PluginClient(std::shared_ptr<ThreadProvider> threads, std::shared_ptr<SignalingClientInterface> sc, rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> pcf)
+		: _threads(threads)
 	{
 		_pluginContext = std::make_shared<PluginContext>(sc, pcf);
 
-		_rtcStatsTaskScheduler = TaskScheduler::create();
+		_pluginThread = _threads->thread("plugin-client");
+
+		_transportThread = _threads->thread("message-transport");
+
+		// the stats task touches the plugin context, keep it in this engine's plugin-client thread
+		_rtcStatsTaskScheduler = TaskScheduler::create(_pluginThread);
 	}
 
 	PluginClient::~PluginClient()
@@ -82,7 +90,9 @@ namespace vi {
 	void PluginClient::attach()
 	{
 		if (auto sc = _pluginContext->signalingClient.lock()) {
-			if (sc->sessionStatus() == SessionStatus::CONNECTED) {
+			// while an expired session is replaced the attach waits for the new one
+			const auto status = sc->sessionStatus();
+			if (status == SessionStatus::CONNECTED || status == SessionStatus::EXPIRED) {
 				sc->attach(_pluginContext->plugin, _pluginContext->opaqueId, shared_from_this());
 			}
 		}
@@ -90,10 +100,16 @@ namespace vi {
 
 	void PluginClient::sendMessage(std::shared_ptr<MessageEvent> event)
 	{
-		if (auto sc = _pluginContext->signalingClient.lock()) {
-			if (sc->sessionStatus() == SessionStatus::CONNECTED) {
-				sc->sendMessage(_pluginContext->handleId, event);
-			}
+		// the signaling client holds it while the session is recovering and fails it if the service is down
+		auto sc = _pluginContext->signalingClient.lock();
+		if (sc) {
+			sc->sendMessage(_pluginContext->handleId, event);
+		}
+		else if (event && event->callback) {
+			// the caller must not wait for an answer that never comes
+			_eventHandlerThread->PostTask(RTC_FROM_HERE, [cb = event->callback]() {
+				(*cb)(false, "service down!");
+			});
 		}
 	}
 
@@ -143,8 +159,7 @@ namespace vi {
 						return;
 					}
 
-					auto eventHandlerThread = TMgr->thread("message-transport");
-					eventHandlerThread->PostTask(RTC_FROM_HERE, [wself, report]() {
+					self->_transportThread->PostTask(RTC_FROM_HERE, [wself, report]() {
 						if (auto self = wself.lock()) {
 							self->onStatsDelivered(report);
 						}
@@ -440,7 +455,7 @@ namespace vi {
 		}
 		if (addTracks && stream && context->pc) {
 			DLOG("Adding local stream");
-			bool simulcast2 = event->simulcast2.value_or(false);
+			const auto layers = HelperUtils::videoLayers(event);
 			for (auto track : stream->GetAudioTracks()) {
 				std::string id = stream->id();
 				webrtc::RTCErrorOr<rtc::scoped_refptr<webrtc::RtpSenderInterface>> result = context->pc->AddTrack(track, { stream->id() });
@@ -449,7 +464,7 @@ namespace vi {
 				}
 			}
 			for (auto track : stream->GetVideoTracks()) {
-				if (!simulcast2) {
+				if (layers.empty()) {
 					//context->pc->AddTrack(track, { stream->id() });
 					webrtc::RTCErrorOr<rtc::scoped_refptr<webrtc::RtpSenderInterface>> result = context->pc->AddTrack(track, { stream->id() });
 					if (!result.ok()) {
@@ -457,33 +472,18 @@ namespace vi {
 					}
 				}
 				else {
-					DLOG("Enabling rid-based simulcasting, track-id: {}", track->id());
+					DLOG("Publishing {} video layer(s), track-id: {}", layers.size(), track->id());
 					webrtc::RtpTransceiverInit init;
 					init.direction = webrtc::RtpTransceiverDirection::kSendRecv;
 					init.stream_ids = { stream->id() };
+					for (const auto& layer : layers) {
+						init.send_encodings.emplace_back(HelperUtils::toRtpEncoding(layer));
+					}
 
-					webrtc::RtpEncodingParameters ph;
-					ph.rid = "h";
-					ph.active = true;
-					ph.max_bitrate_bps = 900000;
-
-					webrtc::RtpEncodingParameters pm;
-					pm.rid = "m";
-					pm.active = true;
-					pm.max_bitrate_bps = 300000;
-					pm.scale_resolution_down_by = 2;
-
-					webrtc::RtpEncodingParameters pl;
-					pl.rid = "m";
-					pl.active = true;
-					pl.max_bitrate_bps = 100000;
-					pl.scale_resolution_down_by = 4;
-
-					init.send_encodings.emplace_back(ph);
-					init.send_encodings.emplace_back(pm);
-					init.send_encodings.emplace_back(pl);
-
-					context->pc->AddTransceiver(track, init);
+					auto result = context->pc->AddTransceiver(track, init);
+					if (!result.ok()) {
+						DLOG("Add transceiver error message: {}", result.error().message());
+					}
 				}
 			}
 		}
@@ -495,7 +495,7 @@ namespace vi {
 				DLOG("Data channel created by Janus.");
 				if (auto self = wself.lock()) {
 					// should be called in SERVICE thread
-					TMgr->thread("plugin-client")->PostTask(RTC_FROM_HERE, [wself, dataChannel]() {
+					self->_pluginThread->PostTask(RTC_FROM_HERE, [wself, dataChannel]() {
 						if (auto self = wself.lock()) {
 							self->createDataChannel(dataChannel->label(), dataChannel);
 						}
@@ -557,7 +557,7 @@ namespace vi {
 				context->candidates.clear();
 				if (auto self = wself.lock()) {
 					// should be called in SERVICE thread
-					TMgr->thread("plugin-client")->PostTask(RTC_FROM_HERE, [wself, event]() {
+					self->_pluginThread->PostTask(RTC_FROM_HERE, [wself, event]() {
 						if (auto self = wself.lock()) {
 							self->_createAnswer(event);
 						}
@@ -848,7 +848,7 @@ namespace vi {
 				DLOG("Add audio track failed.");
 			}
 
-			rtc::scoped_refptr<CapturerTrackSource> capturerSource = CapturerTrackSource::Create();
+			rtc::scoped_refptr<CapturerTrackSource> capturerSource = CapturerTrackSource::Create(_threads->thread("capture-session"));
 			DLOG("create capture source");
 			if (capturerSource) {
 				rtc::scoped_refptr<VideoTrackInterface> captureTrack = _pluginContext->pcf->CreateVideoTrack("video_label", capturerSource);
@@ -1155,7 +1155,8 @@ namespace vi {
 			return;
 		}
 
-		bool simulcast = event->simulcast.value_or(false);
+		// layers are set on the transceiver, the SDP is only munged for the legacy ssrc simulcast
+		bool simulcast = event->simulcast.value_or(false) && HelperUtils::videoLayers(event).empty();
 		if (!simulcast) {
 			DLOG("Creating offer (iceDone = {})", context->iceDone ? "true" : "false");
 		}
@@ -1172,40 +1173,6 @@ namespace vi {
 
 		bool sendVideo = HelperUtils::isVideoSendEnabled(media);
 
-		if (sendVideo && simulcast) {
-			std::vector<rtc::scoped_refptr<webrtc::RtpSenderInterface>> senders = context->pc->GetSenders();
-			rtc::scoped_refptr<webrtc::RtpSenderInterface> sender;
-			for (auto& s : senders) {
-				if (s->track()->kind() == webrtc::MediaStreamTrackInterface::kVideoKind) {
-					sender = s;
-				}
-			}
-			if (sender) {
-				webrtc::RtpParameters params = sender->GetParameters();
-				webrtc::RtpEncodingParameters ph;
-				ph.rid = "h";
-				ph.active = true;
-				ph.max_bitrate_bps = 900000;
-
-				webrtc::RtpEncodingParameters pm;
-				pm.rid = "m";
-				pm.active = true;
-				pm.max_bitrate_bps = 300000;
-				pm.scale_resolution_down_by = 2;
-
-				webrtc::RtpEncodingParameters pl;
-				pl.rid = "m";
-				pl.active = true;
-				pl.max_bitrate_bps = 100000;
-				pl.scale_resolution_down_by = 4;
-
-				params.encodings.emplace_back(ph);
-				params.encodings.emplace_back(pm);
-				params.encodings.emplace_back(pl);
-
-				sender->SetParameters(params);
-			}
-		}
 		std::unique_ptr<CreateSessionDescObserver> createOfferObserver;
 		createOfferObserver.reset(new rtc::RefCountedObject<CreateSessionDescObserver>());
 
@@ -1245,9 +1212,7 @@ namespace vi {
 			desc->ToString(&sdp);
 
 			if (sendVideo && simulcast) {
-				std::vector<std::string> lines = SDPUtils::split(sdp, '\n');
-				SDPUtils::injectSimulcast(2, lines);
-				sdp = SDPUtils::join(lines);
+				SDPUtils::injectSimulcast(2, sdp);
 			}
 
 			JsepConfig jsep{ desc->type(), sdp, false };
@@ -1295,7 +1260,8 @@ namespace vi {
 		if (!context) {
 			return;
 		}
-		bool simulcast = event->simulcast.value_or(false);
+		// layers are set on the transceiver, the SDP is only munged for the legacy ssrc simulcast
+		bool simulcast = event->simulcast.value_or(false) && HelperUtils::videoLayers(event).empty();
 		if (!simulcast) {
 			DLOG("Creating offer (iceDone = {})", context->iceDone ? "true" : "false");
 		}
@@ -1312,38 +1278,6 @@ namespace vi {
 
 		bool sendVideo = HelperUtils::isVideoSendEnabled(media);
 
-		if (sendVideo && simulcast) {
-			DLOG("Enabling Simulcasting");
-			std::vector<rtc::scoped_refptr<webrtc::RtpSenderInterface>> senders = context->pc->GetSenders();
-			rtc::scoped_refptr<webrtc::RtpSenderInterface> sender = senders[1];
-
-			if (sender) {
-				webrtc::RtpParameters params = sender->GetParameters();
-				webrtc::RtpEncodingParameters ph;
-				ph.rid = "h";
-				ph.active = true;
-				ph.max_bitrate_bps = 900000;
-
-				webrtc::RtpEncodingParameters pm;
-				pm.rid = "m";
-				pm.active = true;
-				pm.max_bitrate_bps = 300000;
-				pm.scale_resolution_down_by = 2;
-
-				webrtc::RtpEncodingParameters pl;
-				pl.rid = "m";
-				pl.active = true;
-				pl.max_bitrate_bps = 100000;
-				pl.scale_resolution_down_by = 4;
-
-				params.encodings.emplace_back(ph);
-				params.encodings.emplace_back(pm);
-				params.encodings.emplace_back(pl);
-
-				sender->SetParameters(params);
-			}
-		}
-
 		auto wself = weak_from_this();
 
 		std::unique_ptr<CreateSessionDescObserver> createAnswerObserver;
@@ -1384,9 +1318,7 @@ namespace vi {
 			desc->ToString(&sdp);
 
 			if (sendVideo && simulcast) {
-				std::vector<std::string> lines = SDPUtils::split(sdp, '\n');
-				SDPUtils::injectSimulcast(2, lines);
-				sdp = SDPUtils::join(lines);
+				SDPUtils::injectSimulcast(2, sdp);
 			}
 
 			JsepConfig jsep{ desc->type(), sdp, false };
@@ -1425,7 +1357,7 @@ namespace vi {
 		context->pc->CreateAnswer(createAnswerObserver.release(), options);
 	}
 
-	void PluginClient::cleanupWebrtc(bool hangupRequest)
+	void PluginClient::cleanupWebrtc(bool hangupRequest, std::shared_ptr<TeardownCoordinator> teardown)
 	{
 		DLOG("cleaning webrtc ...");
 
@@ -1441,7 +1373,13 @@ namespace vi {
 
 		// Close PeerConnection
 		if (context->pc) {
-			context->pc->Close();
+			if (teardown) {
+				// closed in parallel with the other PeerConnections going down
+				teardown->closePeerConnection(context->pc);
+			}
+			else {
+				context->pc->Close();
+			}
 			context->pc = nullptr;
 		}
 
@@ -1476,35 +1414,37 @@ namespace vi {
 				std::string candidateStr;
 				candidate->ToString(&candidateStr);
 
-				auto event = std::make_shared<TrickleCandidateEvent>();
-				event->candidate.candidate = candidateStr;
-				event->candidate.sdpMid = candidate->sdp_mid();
-				event->candidate.sdpMLineIndex = (int)candidate->sdp_mline_index();
-				event->candidate.completed = false;
+				CandidateData data;
+				data.candidate = candidateStr;
+				data.sdpMid = candidate->sdp_mid();
+				data.sdpMLineIndex = (int)candidate->sdp_mline_index();
+				data.completed = false;
 
-				if (auto sc = _pluginContext->signalingClient.lock()) {
-					if (sc->sessionStatus() == SessionStatus::CONNECTED) {
-						sc->sendTrickleCandidate(_pluginContext->handleId, event);
+				_pluginThread->PostTask(RTC_FROM_HERE, [wself = weak_from_this(), data]() {
+					if (auto self = wself.lock()) {
+						self->queueTrickleCandidate(data);
 					}
-				}
+				});
 			}
 		}
 		else {
 			DLOG("End of candidates.");
 			_pluginContext->iceDone = true;
 			if (_pluginContext->trickle) {
-				auto event = std::make_shared<TrickleCandidateEvent>();
-				event->candidate.completed = true;
-				if (auto sc = _pluginContext->signalingClient.lock()) {
-					if (sc->sessionStatus() == SessionStatus::CONNECTED) {
-						sc->sendTrickleCandidate(_pluginContext->handleId, event);
+				// end-of-candidates goes out together with whatever is still pending
+				CandidateData data;
+				data.completed = true;
+				_pluginThread->PostTask(RTC_FROM_HERE, [wself = weak_from_this(), data]() {
+					if (auto self = wself.lock()) {
+						self->queueTrickleCandidate(data);
+						self->flushTrickleCandidates();
 					}
-				}
+				});
 			}
 			else {
 				// should be called in SERVICE thread
 				DLOG("send candidates.");
-				TMgr->thread("plugin-client")->PostTask(RTC_FROM_HERE, [wself = weak_from_this()]() {
+				_pluginThread->PostTask(RTC_FROM_HERE, [wself = weak_from_this()]() {
 					if (auto self = wself.lock()) {
 						self->sendSdp();
 					}
@@ -1513,6 +1453,49 @@ namespace vi {
 		}
 	}
 
+	void PluginClient::queueTrickleCandidate(const CandidateData& candidate)
+	{
+		_pendingCandidates.emplace_back(candidate);
+
+		const uint32_t window = _pluginContext->trickleBatchWindowMs;
+		if (window == 0 || _pendingCandidates.size() >= _pluginContext->trickleMaxBatchSize) {
+			flushTrickleCandidates();
+			return;
+		}
+
+		if (_pendingCandidates.size() == 1) {
+			_pluginThread->PostDelayedTask(RTC_FROM_HERE, [wself = weak_from_this(), seq = _trickleFlushSeq]() {
+				auto self = wself.lock();
+				if (self && self->_trickleFlushSeq == seq) {
+					self->flushTrickleCandidates();
+				}
+			}, window);
+		}
+	}
+
+	void PluginClient::flushTrickleCandidates()
+	{
+		++_trickleFlushSeq;
+		if (_pendingCandidates.empty()) {
+			return;
+		}
+
+		auto event = std::make_shared<TrickleCandidateEvent>();
+		if (_pendingCandidates.size() == 1) {
+			event->candidate = _pendingCandidates.front();
+		}
+		else {
+			event->candidates = std::move(_pendingCandidates);
+		}
+		_pendingCandidates.clear();
+
+		DLOG("trickle {} candidate(s)", event->candidates.empty() ? 1 : event->candidates.size());
+		// held during a recovery like any other request
+		if (auto sc = _pluginContext->signalingClient.lock()) {
+			sc->sendTrickleCandidate(_pluginContext->handleId, event);
+		}
+	}
+
 	void PluginClient::OnTrack(rtc::scoped_refptr<webrtc::RtpTransceiverInterface> transceiver)
 	{
 		_eventHandlerThread->PostTask(RTC_FROM_HERE, [transceiver, wself = weak_from_this()]() {
@@ -1560,12 +1543,21 @@ namespace vi {
 		});
 	}
 
-	void PluginClient::onTrickle(const std::string& trickle)
+	void PluginClient::decode(std::shared_ptr<const JanusMessage> message) const
+	{
+		if (message->janus() == "trickle") {
+			message->view<TrickleResponse>();
+		}
+		else if (message->hasMember("jsep")) {
+			message->view<Jsep>("jsep");
+		}
+	}
+
+	void PluginClient::onTrickle(std::shared_ptr<const JanusMessage> trickle)
 	{
-		std::string err;
-		std::shared_ptr<TrickleResponse> model = fromJsonString<TrickleResponse>(trickle, err);
-		if (!err.empty()) {
-			DLOG("parse JanusResponse failed");
+		auto model = trickle->view<TrickleResponse>();
+		if (!model) {
+			DLOG("parse TrickleResponse failed");
 			return;
 		}
 
@@ -1620,9 +1612,9 @@ namespace vi {
 		}
 	}
 
-	void PluginClient::onCleanup()
+	void PluginClient::onCleanup(std::shared_ptr<TeardownCoordinator> teardown)
 	{
-		cleanupWebrtc();
+		cleanupWebrtc(true, teardown);
 	}
 }
 
@@ -15,6 +15,8 @@
 namespace vi {
 	class SignalingClientInterface;
 	class TaskScheduler;
+	class ThreadProvider;
+	class TeardownCoordinator;
 
 	class PluginClient
 		: public ISignalingEventHandler
@@ -22,7 +24,8 @@ namespace vi {
 		, public std::enable_shared_from_this<PluginClient>
 	{
 	public:
-		PluginClient(std::shared_ptr<SignalingClientInterface> sc, rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> pcf);
+		// |threads| and |pcf| belong to the engine of |sc|.
+		PluginClient(std::shared_ptr<ThreadProvider> threads, std::shared_ptr<SignalingClientInterface> sc, rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> pcf);
 
 		~PluginClient();
 
@@ -76,7 +79,13 @@ namespace vi {
 
 		void stopAllTracks(rtc::scoped_refptr<webrtc::MediaStreamInterface> stream);
 
-		void cleanupWebrtc(bool hangupRequest = true);
+		void cleanupWebrtc(bool hangupRequest = true, std::shared_ptr<TeardownCoordinator> teardown = nullptr);
+
+		// should be called in plugin-client thread
+		void queueTrickleCandidate(const CandidateData& candidate);
+
+		// should be called in plugin-client thread
+		void flushTrickleCandidates();
 
 	protected:
 		// webrtc events
@@ -111,9 +120,13 @@ namespace vi {
 	public:
 		// signaling service events
 
-		void onTrickle(const std::string& trickle) override;
+		void onTrickle(std::shared_ptr<const JanusMessage> trickle) override;
 
-		void onCleanup() override;
+		void onCleanup(std::shared_ptr<TeardownCoordinator> teardown) override;
+
+		// Materializes the typed views the handlers of |message| will ask for. Runs on a decode
+		// worker before the message reaches the plugin-client thread, so it must not touch state.
+		virtual void decode(std::shared_ptr<const JanusMessage> message) const;
 
 	protected:
 		uint64_t _id = 0;
@@ -128,8 +141,21 @@ namespace vi {
 
 		rtc::Thread* _eventHandlerThread = nullptr;
 
+		std::shared_ptr<ThreadProvider> _threads;
+
+		// resolved once, the thread provider is not consulted per post
+		rtc::Thread* _pluginThread = nullptr;
+
+		rtc::Thread* _transportThread = nullptr;
+
 		// key: mid, value: receiver-id
 		std::unordered_map<std::string, std::string> _receiverId2Mid;
+
+		// local candidates waiting for the next trickle request, only touched in plugin-client thread
+		std::vector<CandidateData> _pendingCandidates;
+
+		// bumped on every flush so that an outdated flush timer does nothing
+		uint64_t _trickleFlushSeq = 0;
 	};
 }
 
@@ -40,6 +40,10 @@ namespace vi {
 		std::shared_ptr<CreateOfferAnswerCallback> offerAnswerCallback;
 
 		absl::optional<bool> trickle = true;
+		// local candidates gathered within this window go out in one trickle request, 0 sends them one by one
+		uint32_t trickleBatchWindowMs = 20;
+		// a batch reaching this size is flushed without waiting for the window
+		size_t trickleMaxBatchSize = 16;
 		std::atomic_bool iceDone = false;
 		std::atomic_bool sdpSent = false;
 		std::atomic_bool streamExternal = false;
@@ -0,0 +1,249 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include "absl/types/optional.h"
+#include "rtc_base/thread.h"
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+#include <exception>
+#define VI_HAS_COROUTINES 1
+#endif
+
+namespace vi {
+	// Why a ProxyFuture completed without a value, |code| is the Janus error code if there is one.
+	struct ProxyError {
+		int64_t code = 0;
+		std::string reason;
+	};
+
+	// Result of a proxy call that was posted instead of waited for, see WEAK_PROXY_FUTURE_METHODn.
+	// It completes once, either with a value or with an error. Copies share the same state.
+	template <typename R>
+	class ProxyFuture {
+	public:
+		ProxyFuture() : _state(std::make_shared<State>()) {}
+
+		static ProxyFuture ready(R value)
+		{
+			ProxyFuture future;
+			future.set(std::move(value));
+			return future;
+		}
+
+		static ProxyFuture failed(ProxyError error)
+		{
+			ProxyFuture future;
+			future.fail(std::move(error));
+			return future;
+		}
+
+		bool isReady() const
+		{
+			std::lock_guard<std::mutex> lock(_state->mutex);
+			return _state->value.has_value() || _state->error.has_value();
+		}
+
+		bool hasError() const
+		{
+			std::lock_guard<std::mutex> lock(_state->mutex);
+			return _state->error.has_value();
+		}
+
+		// Valid once hasError()
+		ProxyError error() const
+		{
+			std::lock_guard<std::mutex> lock(_state->mutex);
+			return _state->error.value_or(ProxyError());
+		}
+
+		// Blocks until the call ran, which is what the proxy avoids, don't call it on the UI thread.
+		// A default constructed R if it failed, see error().
+		R get() const
+		{
+			std::unique_lock<std::mutex> lock(_state->mutex);
+			_state->cv.wait(lock, [this]() { return _state->value.has_value() || _state->error.has_value(); });
+			return _state->value ? *_state->value : R();
+		}
+
+		// |callback| runs with the value, or |errback| (if any) with the error, on the thread calling
+		// then(), if it is an rtc::Thread, otherwise on the thread completing the future.
+		void then(std::function<void(R)> callback, std::function<void(ProxyError)> errback = nullptr)
+		{
+			std::unique_lock<std::mutex> lock(_state->mutex);
+			if (!_state->value && !_state->error) {
+				_state->callback = std::move(callback);
+				_state->errback = std::move(errback);
+				_state->thread = rtc::Thread::Current();
+				return;
+			}
+			if (_state->value) {
+				R value = *_state->value;
+				lock.unlock();
+				callback(std::move(value));
+				return;
+			}
+			ProxyError error = *_state->error;
+			lock.unlock();
+			if (errback) {
+				errback(std::move(error));
+			}
+		}
+
+		void set(R value)
+		{
+			std::function<void(R)> callback;
+			rtc::Thread* thread = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(_state->mutex);
+				if (_state->value || _state->error) {
+					return;
+				}
+				_state->value = value;
+				callback = std::move(_state->callback);
+				thread = _state->thread;
+				_state->errback = nullptr;
+			}
+			_state->cv.notify_all();
+			dispatch(thread, std::move(callback), std::move(value));
+		}
+
+		void fail(ProxyError error)
+		{
+			std::function<void(ProxyError)> errback;
+			rtc::Thread* thread = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(_state->mutex);
+				if (_state->value || _state->error) {
+					return;
+				}
+				_state->error = error;
+				errback = std::move(_state->errback);
+				thread = _state->thread;
+				_state->callback = nullptr;
+			}
+			_state->cv.notify_all();
+			dispatch(thread, std::move(errback), std::move(error));
+		}
+
+#if defined(VI_HAS_COROUTINES)
+		// co_await resumes the coroutine on the awaiting thread, a coroutine may return a ProxyFuture too.
+		// A failed future resumes with a default constructed R, check error() then.
+		bool await_ready() const { return isReady(); }
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			then([handle](R) { handle.resume(); }, [handle](ProxyError) { handle.resume(); });
+		}
+
+		R await_resume() const { return get(); }
+
+		struct promise_type {
+			ProxyFuture future;
+
+			ProxyFuture get_return_object() { return future; }
+
+			std::suspend_never initial_suspend() noexcept { return {}; }
+
+			std::suspend_never final_suspend() noexcept { return {}; }
+
+			void return_value(R value) { future.set(std::move(value)); }
+
+			void unhandled_exception() { std::terminate(); }
+		};
+#endif
+
+	private:
+		template <typename T>
+		static void dispatch(rtc::Thread* thread, std::function<void(T)> callback, T arg)
+		{
+			if (!callback) {
+				return;
+			}
+			if (thread && !thread->IsCurrent()) {
+				thread->PostTask(RTC_FROM_HERE, [callback, arg]() {
+					callback(arg);
+				});
+			}
+			else {
+				callback(std::move(arg));
+			}
+		}
+
+		struct State {
+			std::mutex mutex;
+			std::condition_variable cv;
+			absl::optional<R> value;
+			absl::optional<ProxyError> error;
+			std::function<void(R)> callback;
+			std::function<void(ProxyError)> errback;
+			rtc::Thread* thread = nullptr;
+		};
+
+		std::shared_ptr<State> _state;
+	};
+
+	namespace detail {
+		template <typename Tuple, typename... R>
+		struct WhenAllState {
+			std::mutex mutex;
+			std::tuple<absl::optional<R>...> values;
+			size_t pending = sizeof...(R);
+			ProxyFuture<Tuple> result;
+		};
+
+		// the first error fails the whole, later ones are dropped by fail()
+		template <typename State>
+		std::function<void(ProxyError)> failWith(std::shared_ptr<State> state)
+		{
+			return [state](ProxyError error) {
+				state->result.fail(std::move(error));
+			};
+		}
+
+		template <typename Tuple, typename State, size_t... Is>
+		void complete(State& state, std::index_sequence<Is...>)
+		{
+			state.result.set(Tuple(std::move(*std::get<Is>(state.values))...));
+		}
+
+		template <typename Tuple, typename... R, size_t... Is>
+		ProxyFuture<Tuple> whenAll(std::index_sequence<Is...>, ProxyFuture<R>... futures)
+		{
+			auto state = std::make_shared<WhenAllState<Tuple, R...>>();
+			auto result = state->result;
+			int unused[] = { 0, (futures.then([state](typename std::tuple_element<Is, Tuple>::type value) {
+				{
+					std::lock_guard<std::mutex> lock(state->mutex);
+					std::get<Is>(state->values) = std::move(value);
+					if (--state->pending != 0) {
+						return;
+					}
+				}
+				complete<Tuple>(*state, std::make_index_sequence<std::tuple_size<Tuple>::value>());
+			}, failWith(state)), 0)... };
+			(void)unused;
+			return result;
+		}
+	}
+
+	// Fulfilled with all the values once every one of |futures| is, on the thread calling whenAll().
+	// Fails as soon as one of them does.
+	template <typename... R>
+	ProxyFuture<std::tuple<R...>> whenAll(ProxyFuture<R>... futures)
+	{
+		return detail::whenAll<std::tuple<R...>>(std::index_sequence_for<R...>(), std::move(futures)...);
+	}
+}
@@ -6,5 +6,10 @@ namespace vi {
 	{
 		return RTCEngine::instance();
 	}
+
+	std::shared_ptr<IRTCEngine> RTCEngineFactory::createEngine(const EngineOptions& options)
+	{
+		return RTCEngine::create(options);
+	}
 }
 
@@ -4,10 +4,15 @@
 
 namespace vi {
 	class IRTCEngine;
+	struct EngineOptions;
 	class RTCEngineFactory
 	{
 	public:
+		// The process-wide default engine, the same one on every call.
 		static std::shared_ptr<IRTCEngine> createEngine();
+
+		// A new engine on every call, independent of the others (e.g. one per bot).
+		static std::shared_ptr<IRTCEngine> createEngine(const EngineOptions& options);
 	};
 }
 
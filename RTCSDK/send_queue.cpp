@@ -0,0 +1,106 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#include "send_queue.h"
+#include "rtc_base/time_utils.h"
+#include "logger/logger.h"
+
+namespace vi {
+	SendPriority SendQueue::priorityOf(TransactionKind kind)
+	{
+		switch (kind) {
+		case TransactionKind::KEEPALIVE:
+		case TransactionKind::HANGUP:
+			return SendPriority::URGENT;
+		case TransactionKind::TRICKLE:
+			return SendPriority::TRICKLE;
+		default:
+			return SendPriority::BULK;
+		}
+	}
+
+	bool SendQueue::push(Item item)
+	{
+		item.enqueuedMs = rtc::TimeMillis();
+
+		std::lock_guard<std::mutex> locker(_mutex);
+		auto& queue = _queues[(size_t)item.priority];
+		if (item.handler && !item.handler->coalesceKey.empty()) {
+			for (auto& queued : queue) {
+				if (!queued.handler || queued.handler->coalesceKey != item.handler->coalesceKey) {
+					continue;
+				}
+				DLOG("coalesce {} into {}", item.handler->transaction, queued.handler->transaction);
+				auto previous = queued.handler->callback;
+				auto latest = item.handler->callback;
+				if (previous && latest) {
+					item.handler->callback = std::make_shared<JCCallback>([previous, latest](const std::string& json) {
+						(*previous)(json);
+						(*latest)(json);
+					});
+				}
+				else if (previous) {
+					item.handler->callback = previous;
+				}
+				// keep the queue position (and wait time) of the superseded request
+				item.enqueuedMs = queued.enqueuedMs;
+				queued = std::move(item);
+				++_coalesced;
+				return true;
+			}
+		}
+		queue.emplace_back(std::move(item));
+		return false;
+	}
+
+	bool SendQueue::pop(Item& item)
+	{
+		std::lock_guard<std::mutex> locker(_mutex);
+		for (size_t i = 0; i < _queues.size(); ++i) {
+			if (_queues[i].empty()) {
+				continue;
+			}
+			item = std::move(_queues[i].front());
+			_queues[i].pop_front();
+			_wait[i].add(rtc::TimeMillis() - item.enqueuedMs);
+			return true;
+		}
+		return false;
+	}
+
+	void SendQueue::clear(std::vector<Item>& dropped)
+	{
+		std::lock_guard<std::mutex> locker(_mutex);
+		for (auto& queue : _queues) {
+			for (auto& item : queue) {
+				dropped.emplace_back(std::move(item));
+			}
+			queue.clear();
+		}
+	}
+
+	size_t SendQueue::size() const
+	{
+		std::lock_guard<std::mutex> locker(_mutex);
+		size_t size = 0;
+		for (const auto& queue : _queues) {
+			size += queue.size();
+		}
+		return size;
+	}
+
+	SendQueueStats SendQueue::stats() const
+	{
+		SendQueueStats stats;
+		std::lock_guard<std::mutex> locker(_mutex);
+		for (size_t i = 0; i < _queues.size(); ++i) {
+			stats.depth[i] = _queues[i].size();
+			stats.wait[i] = _wait[i].snapshot();
+		}
+		stats.coalesced = _coalesced;
+		return stats;
+	}
+}
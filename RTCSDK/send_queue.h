@@ -0,0 +1,55 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#pragma once
+
+#include <array>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "i_message_transport.h"
+#include "utils/latency_histogram.h"
+
+namespace vi {
+	// Outbound request queue of the signaling socket, one FIFO per priority class.
+	// A request whose handler carries a coalesce key replaces a queued request with the
+	// same key in place; the callbacks of both receive the response of the one sent.
+	class SendQueue
+	{
+	public:
+		struct Item {
+			JsonBufferPtr buffer;
+			std::shared_ptr<JCHandler> handler;
+			SendPriority priority = SendPriority::BULK;
+			int64_t enqueuedMs = 0;
+		};
+
+		static SendPriority priorityOf(TransactionKind kind);
+
+		// Returns true if |item| was merged into a queued request.
+		bool push(Item item);
+
+		// Pops the oldest request of the most urgent non-empty class.
+		bool pop(Item& item);
+
+		void clear(std::vector<Item>& dropped);
+
+		size_t size() const;
+
+		SendQueueStats stats() const;
+
+	private:
+		mutable std::mutex _mutex;
+
+		std::array<std::deque<Item>, (size_t)SendPriority::COUNT> _queues;
+
+		std::array<LatencyHistogram, (size_t)SendPriority::COUNT> _wait;
+
+		uint64_t _coalesced = 0;
+	};
+}
@@ -16,6 +16,17 @@ namespace vi {
         std::string serverUrl;
     };
 
+    // Fixed when the engine is created.
+    struct EngineOptions {
+        // run the PeerConnectionFactory on the signaling/worker/network threads shared by every
+        // engine created with this option, instead of three threads of its own
+        bool sharePeerConnectionThreads = false;
+
+        // run the signaling websocket on the io_context shared by every engine created with this
+        // option (see WebsocketEndpoint::shared()), instead of an io_context thread of its own
+        bool shareSignalingEndpoint = false;
+    };
+
     class IRTCEngine {
     public:
         virtual ~IRTCEngine() {}
@@ -7,12 +7,20 @@
 #pragma once
 
 #include <memory>
+#include "api/scoped_refptr.h"
+
+namespace webrtc {
+    class PeerConnectionFactoryInterface;
+}
 
 namespace vi {
     class ThreadProvider;
     class IServiceFactory;
     class SignalingClientInterface;
 
+    // Everything an engine runs on: its named threads, services, signaling client and the
+    // PeerConnectionFactory. Engines don't share any of it, except the PeerConnectionFactory threads
+    // and the io_context of the signaling websocket when asked to (see EngineOptions).
     class IUnifiedFactory {
     public:
         virtual ~IUnifiedFactory() {}
@@ -21,11 +29,13 @@ namespace vi {
 
         virtual void destroy() = 0;
 
-        virtual std::unique_ptr<vi::ThreadProvider>& getThreadProvider() = 0;
+        virtual std::shared_ptr<vi::ThreadProvider> getThreadProvider() = 0;
 
         virtual std::shared_ptr<vi::IServiceFactory> getServiceFactory() = 0;
 
         virtual std::shared_ptr<vi::SignalingClientInterface> getSignalingClient() = 0;
+
+        virtual rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> getPeerConnectionFactory() = 0;
     };
 
 }
\ No newline at end of file
@@ -9,52 +9,27 @@
 #include <memory>
 #include "unified_factory.h"
 #include "video_room_client.h"
-#include "api/video_codecs/builtin_video_decoder_factory.h"
-#include "api/video_codecs/builtin_video_encoder_factory.h"
-#include "api/audio_codecs/builtin_audio_decoder_factory.h"
-#include "api/audio_codecs/builtin_audio_encoder_factory.h"
-#include "modules/audio_device/include/audio_device.h"
-#include "modules/audio_processing/include/audio_processing.h"
+#include "utils/thread_provider.h"
 
 namespace vi {
-	RTCEngine::RTCEngine()
+	RTCEngine::RTCEngine(const EngineOptions& options)
+		: _engineOptions(options)
 	{
 
 	}
 
 	RTCEngine::~RTCEngine()
 	{
-		_pcf = nullptr;
+
 	}
 
 	void RTCEngine::init()
 	{
-		if (!_pcf) {
-			_signaling = rtc::Thread::Create();
-			_signaling->SetName("pc_signaling_thread", nullptr);
-			_signaling->Start();
-			_worker = rtc::Thread::Create();
-			_worker->SetName("pc_worker_thread", nullptr);
-			_worker->Start();
-			_network = rtc::Thread::CreateWithSocketServer();
-			_network->SetName("pc_network_thread", nullptr);
-			_network->Start();
-			_pcf = webrtc::CreatePeerConnectionFactory(
-				_network.get() /* network_thread */,
-				_worker.get() /* worker_thread */,
-				_signaling.get() /* signaling_thread */,
-				nullptr /* default_adm */,
-				webrtc::CreateBuiltinAudioEncoderFactory(),
-				webrtc::CreateBuiltinAudioDecoderFactory(),
-				webrtc::CreateBuiltinVideoEncoderFactory(),
-				webrtc::CreateBuiltinVideoDecoderFactory(),
-				nullptr /* audio_mixer */,
-				nullptr /* audio_processing */);
+		if (!_unifiedFactory) {
+			_unifiedFactory = std::make_shared<UnifiedFactory>(_engineOptions.sharePeerConnectionThreads, _engineOptions.shareSignalingEndpoint);
+			_unifiedFactory->init();
 		}
 
-		_unifiedFactory = std::make_shared<UnifiedFactory>();
-		_unifiedFactory->init();
-
 		_unifiedFactory->getSignalingClient()->registerObserver(shared_from_this());
 	}
 
@@ -83,7 +58,7 @@ namespace vi {
 
 	void RTCEngine::startup()
 	{
-		auto sc = uFactory->getSignalingClient();
+		auto sc = _unifiedFactory->getSignalingClient();
 		sc->connect(_options.serverUrl);
 	}
 
@@ -94,8 +69,9 @@ namespace vi {
 
 	std::shared_ptr<VideoRoomClientInterface> RTCEngine::createVideoRoomClient()
 	{
-		auto sc = uFactory->getSignalingClient();
-		return VideoRoomClientProxy::Create(TMgr->thread("plugin-client"), std::make_shared<vi::VideoRoomClient>(sc, _pcf));
+		auto sc = _unifiedFactory->getSignalingClient();
+		auto threads = _unifiedFactory->getThreadProvider();
+		return VideoRoomClientProxy::Create(threads->thread("plugin-client"), std::make_shared<vi::VideoRoomClient>(threads, sc, _unifiedFactory->getPeerConnectionFactory()));
 	}
 
 	std::shared_ptr<IUnifiedFactory> RTCEngine::getUnifiedFactory()
@@ -31,11 +31,18 @@ namespace vi {
             static std::shared_ptr<IRTCEngine> _instance;
             static std::once_flag ocf;
             std::call_once(ocf, []() {
-                _instance.reset(new RTCEngine());
+                _instance.reset(new RTCEngine(EngineOptions()));
             });
             return _instance;
         }
 
+        // An engine independent of instance() and of any other one: threads, signaling client
+        // and factories are its own.
+        static std::shared_ptr<IRTCEngine> create(const EngineOptions& options)
+        {
+            return std::shared_ptr<IRTCEngine>(new RTCEngine(options));
+        }
+
         ~RTCEngine() override;
 
         void init() override;
@@ -60,7 +67,7 @@ namespace vi {
         void onSessionStatus(SessionStatus status) override;
 
     private:
-        RTCEngine();
+        explicit RTCEngine(const EngineOptions& options);
 
         RTCEngine(const RTCEngine&) = delete;
 
@@ -75,14 +82,12 @@ namespace vi {
 
         Options _options;
 
-        rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> _pcf;
-        std::unique_ptr<rtc::Thread> _signaling;
-        std::unique_ptr<rtc::Thread> _worker;
-        std::unique_ptr<rtc::Thread> _network;
+        EngineOptions _engineOptions;
     };
 
 }
 
+// the default engine only, SDK components are handed the threads of their own engine
 #define rtcEngine std::dynamic_pointer_cast<RTCEngine>(vi::RTCEngine::instance())
 #define uFactory rtcEngine->getUnifiedFactory()
 #define fetchService(S) uFactory->getServiceFactory()->getService<S>()
\ No newline at end of file
@@ -5,32 +5,104 @@
  **/
 
 #include "unified_factory.h"
+#include <mutex>
 #include "utils/service_factory.hpp"
 #include "signaling_client.h"
 #include "signaling_client_interface.h"
 #include "utils/thread_provider.h"
+#include "websocket/websocket_endpoint.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/event.h"
+#include "logger/logger.h"
+#include "api/create_peerconnection_factory.h"
+#include "api/video_codecs/builtin_video_decoder_factory.h"
+#include "api/video_codecs/builtin_video_encoder_factory.h"
+#include "api/audio_codecs/builtin_audio_decoder_factory.h"
+#include "api/audio_codecs/builtin_audio_encoder_factory.h"
+#include "modules/audio_device/include/audio_device.h"
+#include "modules/audio_processing/include/audio_processing.h"
 
 namespace vi {
-	UnifiedFactory::UnifiedFactory()
+	namespace {
+		// how long destroy() lets the session and its PeerConnections take to go down
+		const uint32_t kTeardownDeadlineMs = 2000;
+
+		// for the completion to come through once the deadline passed
+		const int kTeardownGraceMs = 200;
+
+		std::shared_ptr<PeerConnectionThreads> createPeerConnectionThreads()
+		{
+			auto threads = std::make_shared<PeerConnectionThreads>();
+			threads->signaling = rtc::Thread::Create();
+			threads->signaling->SetName("pc_signaling_thread", nullptr);
+			threads->signaling->Start();
+			threads->worker = rtc::Thread::Create();
+			threads->worker->SetName("pc_worker_thread", nullptr);
+			threads->worker->Start();
+			threads->network = rtc::Thread::CreateWithSocketServer();
+			threads->network->SetName("pc_network_thread", nullptr);
+			threads->network->Start();
+			return threads;
+		}
+
+		// alive as long as one factory uses it
+		std::shared_ptr<PeerConnectionThreads> sharedPeerConnectionThreads()
+		{
+			static std::mutex mutex;
+			static std::weak_ptr<PeerConnectionThreads> shared;
+
+			std::lock_guard<std::mutex> locker(mutex);
+			auto threads = shared.lock();
+			if (!threads) {
+				threads = createPeerConnectionThreads();
+				shared = threads;
+			}
+			return threads;
+		}
+	}
+
+	UnifiedFactory::UnifiedFactory(bool sharePeerConnectionThreads, bool shareSignalingEndpoint)
+		: _sharePeerConnectionThreads(sharePeerConnectionThreads)
+		, _shareSignalingEndpoint(shareSignalingEndpoint)
 	{
 
 	}
 
+	UnifiedFactory::~UnifiedFactory()
+	{
+		_pcf = nullptr;
+	}
+
 	void UnifiedFactory::init()
 	{
 		if (!_threadProvider) {
-			_threadProvider = std::make_unique<vi::ThreadProvider>();
+			_threadProvider = std::make_shared<vi::ThreadProvider>();
 			_threadProvider->init();
 			_threadProvider->create({ "signaling-service", "plugin-client", "message-transport", "capture-session" });
 		}
 
+		if (!_pcf) {
+			_pcThreads = _sharePeerConnectionThreads ? sharedPeerConnectionThreads() : createPeerConnectionThreads();
+			_pcf = webrtc::CreatePeerConnectionFactory(
+				_pcThreads->network.get() /* network_thread */,
+				_pcThreads->worker.get() /* worker_thread */,
+				_pcThreads->signaling.get() /* signaling_thread */,
+				nullptr /* default_adm */,
+				webrtc::CreateBuiltinAudioEncoderFactory(),
+				webrtc::CreateBuiltinAudioDecoderFactory(),
+				webrtc::CreateBuiltinVideoEncoderFactory(),
+				webrtc::CreateBuiltinVideoDecoderFactory(),
+				nullptr /* audio_mixer */,
+				nullptr /* audio_processing */);
+		}
+
 		if (!_serviceFactory) {
 			_serviceFactory = std::make_shared<vi::ServiceFactory>();
 			_serviceFactory->init();
 		}
 
 		if (!_signalingClient) {
-			_signalingClient = vi::SignalingClientProxy::Create(_threadProvider->thread("signaling-service"), std::make_shared<vi::SignalingClient>());
+			_signalingClient = vi::SignalingClientProxy::Create(_threadProvider->thread("signaling-service"), std::make_shared<vi::SignalingClient>(_threadProvider, _shareSignalingEndpoint ? WebsocketEndpoint::shared() : nullptr));
 			_signalingClient->init();
 		}
 	}
@@ -38,7 +110,18 @@ namespace vi {
 	void UnifiedFactory::destroy()
 	{
 		if (_signalingClient) {
-			_signalingClient->cleanup();
+			// the same as cleanup(), but the caller waits for it, never longer than the deadline
+			auto done = std::make_shared<rtc::Event>();
+			auto event = std::make_shared<DestroySessionEvent>();
+			event->notifyDestroyed = true;
+			event->cleanupHandles = true;
+			event->deadlineMs = kTeardownDeadlineMs;
+			event->callback = std::make_shared<EventCallback>([done](bool success, const std::string& response) {
+				DLOG("destroy, success = {}, response = {}", success, response.c_str());
+				done->Set();
+			});
+			_signalingClient->destroy(event);
+			done->Wait(kTeardownDeadlineMs + kTeardownGraceMs);
 		}
 
 		if (_serviceFactory) {
@@ -50,7 +133,7 @@ namespace vi {
 		}
 	}
 
-	std::unique_ptr<vi::ThreadProvider>& UnifiedFactory::getThreadProvider()
+	std::shared_ptr<vi::ThreadProvider> UnifiedFactory::getThreadProvider()
 	{
 		return _threadProvider;
 	}
@@ -64,4 +147,9 @@ namespace vi {
 	{
 		return _signalingClient;
 	}
+
+	rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> UnifiedFactory::getPeerConnectionFactory()
+	{
+		return _pcf;
+	}
 }
\ No newline at end of file
@@ -11,27 +11,54 @@
 #include "i_unified_factory.h"
 #include "utils/i_service.hpp"
 
+namespace rtc {
+    class Thread;
+}
+
 namespace vi {
+    // Signaling, worker and network threads of a PeerConnectionFactory.
+    struct PeerConnectionThreads {
+        std::unique_ptr<rtc::Thread> signaling;
+        std::unique_ptr<rtc::Thread> worker;
+        std::unique_ptr<rtc::Thread> network;
+    };
+
     class UnifiedFactory : public IUnifiedFactory, public std::enable_shared_from_this<UnifiedFactory>
     {
     public:
-        UnifiedFactory();
+        // With |sharePeerConnectionThreads| the PeerConnectionFactory runs on the threads every
+        // such factory in the process uses, otherwise on threads of its own. Likewise the signaling
+        // websocket with |shareSignalingEndpoint|.
+        explicit UnifiedFactory(bool sharePeerConnectionThreads = false, bool shareSignalingEndpoint = false);
+
+        ~UnifiedFactory();
 
         void init() override;
 
         void destroy() override;
 
-        std::unique_ptr<vi::ThreadProvider>& getThreadProvider() override;
+        std::shared_ptr<vi::ThreadProvider> getThreadProvider() override;
 
         std::shared_ptr<vi::IServiceFactory> getServiceFactory() override;
 
         std::shared_ptr<vi::SignalingClientInterface> getSignalingClient() override;
 
+        rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> getPeerConnectionFactory() override;
+
     private:
-        std::unique_ptr<vi::ThreadProvider> _threadProvider;
+        bool _sharePeerConnectionThreads;
+
+        bool _shareSignalingEndpoint;
+
+        std::shared_ptr<vi::ThreadProvider> _threadProvider;
 
         std::shared_ptr<vi::IServiceFactory> _serviceFactory;
 
         std::shared_ptr<vi::SignalingClientInterface> _signalingClient;
+
+        // declared before |_pcf|, which must go first
+        std::shared_ptr<PeerConnectionThreads> _pcThreads;
+
+        rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> _pcf;
     };
 }
\ No newline at end of file
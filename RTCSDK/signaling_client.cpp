@@ -13,13 +13,36 @@
 #include "service/rtc_engine.h"
 #include "utils/thread_provider.h"
 #include "utils/task_scheduler.h"
+#include "utils/strand_pool.h"
+#include "teardown_coordinator.h"
 #include "message_models.h"
+#include "janus_message.h"
 #include "absl/types/optional.h"
+#include "rtc_base/time_utils.h"
+#include <algorithm>
+#include <random>
+#include <thread>
 
 namespace vi {
+	namespace {
+		// reconnect delays grow from the base to the cap, each drawn from [delay / 2, delay]
+		const uint32_t kReconnectBaseDelayMs = 250;
 
-	SignalingClient::SignalingClient()
-		: _eventHandlerThread(nullptr)
+		const uint32_t kReconnectMaxDelayMs = 10000;
+
+		uint32_t jitteredDelay(uint32_t attempt)
+		{
+			static thread_local std::mt19937 generator(std::random_device{}());
+			uint64_t delay = std::min<uint64_t>(kReconnectMaxDelayMs, (uint64_t)kReconnectBaseDelayMs << std::min<uint32_t>(attempt, 16));
+			std::uniform_int_distribution<uint32_t> distribution((uint32_t)delay / 2, (uint32_t)delay);
+			return distribution(generator);
+		}
+	}
+
+	SignalingClient::SignalingClient(std::shared_ptr<ThreadProvider> threads, std::shared_ptr<WebsocketEndpoint> websocket)
+		: _threads(threads)
+		, _websocket(websocket)
+		, _eventHandlerThread(nullptr)
 	{
 	}
 
@@ -35,13 +58,17 @@ namespace vi {
 
 	void SignalingClient::init()
 	{
-		_eventHandlerThread = TMgr->thread("plugin-client");
+		_eventHandlerThread = _threads->thread("plugin-client");
 		
-		_client = std::make_shared<vi::JanusApiClient>("signaling-service");
+		_client = std::make_shared<vi::JanusApiClient>(_threads, "signaling-service", _websocket);
 		_client->addListener(shared_from_this());
 		_client->init();
 
-		_heartbeatTaskScheduler = TaskScheduler::create();
+		_signalingThread = _threads->thread("signaling-service");
+
+		_heartbeatTaskScheduler = TaskScheduler::create(_signalingThread);
+
+		_decodePool = std::make_unique<StrandPool>("janus-decode", std::min<size_t>(4, std::max<unsigned>(2, std::thread::hardware_concurrency() / 2)));
 	}
 
 	void SignalingClient::cleanup()
@@ -57,7 +84,7 @@ namespace vi {
 
 	void SignalingClient::registerObserver(std::shared_ptr<ISignalingClientObserver> observer)
 	{
-		UniversalObservable<ISignalingClientObserver>::addWeakObserver(observer, "main");
+		UniversalObservable<ISignalingClientObserver>::addWeakObserver(observer, _threads->thread("main"));
 	}
 
 	void SignalingClient::unregisterObserver(std::shared_ptr<ISignalingClientObserver> observer)
@@ -72,6 +99,7 @@ namespace vi {
 			return;
 		}
 		DLOG("janus api client, connecting...");
+		_server = url;
 		_client->connect(url);
 
 		//this->onOpened();
@@ -82,17 +110,33 @@ namespace vi {
 		return _sessionStatus;
 	}
 
+	LatencyHistogram::Snapshot SignalingClient::recoveryLatency()
+	{
+		return _recoveryLatency.snapshot();
+	}
+
+	LatencyHistogram::Snapshot SignalingClient::decodeQueueLatency(int64_t handleId)
+	{
+		return _decodePool ? _decodePool->queueLatency(handleId) : LatencyHistogram::Snapshot();
+	}
+
 	void SignalingClient::attach(const std::string& plugin, const std::string& opaqueId, std::shared_ptr<PluginClient> pluginClient)
 	{
 		if (!pluginClient) {
 			return;
 		}
 
+		if (_sessionStatus == SessionStatus::EXPIRED) {
+			// the handles of the expired session attach again to its replacement
+			_pendingAttaches.emplace_back(PendingAttach{ plugin, opaqueId, pluginClient });
+			return;
+		}
+
 		auto lambda = [wself = weak_from_this(), pluginClient](const std::string& json) {
-			std::string err;
-			std::shared_ptr<AttachResponse> model = fromJsonString<AttachResponse>(json, err);
-			if (!err.empty()) {
-				DLOG("parse JanusResponse failed");
+			JsonSaxResult result;
+			std::shared_ptr<AttachResponse> model = fromJsonStringSax<AttachResponse>(json, result);
+			if (!result.ok()) {
+				DLOG("parse AttachResponse failed, status: {}, key: {}", (int)result.status, result.key);
 				return;
 			}
 
@@ -132,55 +176,119 @@ namespace vi {
 
 	void SignalingClient::reconnectSession()
 	{
-		// TODO: ?
+		DLOG("claiming session {}", _sessionId);
 		std::shared_ptr<CreateSessionEvent> event = std::make_shared<CreateSessionEvent>();
 		event->reconnect = true;
-		auto lambda = [](bool success, const std::string& response) {
-			DLOG("response: {}", response.c_str());
+		auto lambda = [wself = weak_from_this(), thread = _signalingThread](bool success, const std::string& response) {
+			thread->PostTask(RTC_FROM_HERE, [wself, success, response]() {
+				auto self = wself.lock();
+				if (!self) {
+					return;
+				}
+				self->_recovering = false;
+				self->_reconnectAttempts = 0;
+				if (success) {
+					// the handles moved with the session, PeerConnections keep running untouched
+					int64_t elapsed = rtc::TimeMillis() - self->_connectionLostMs;
+					self->_recoveryLatency.add(elapsed);
+					self->_connected = true;
+					DLOG("session {} recovered in {} ms with {} handle(s)", self->_sessionId, elapsed, self->_pluginClientMap.size());
+					// the in-flight requests first, then the ones queued during the outage
+					self->_client->replayPending();
+					self->_client->resume();
+					return;
+				}
+
+				WLOG("claiming session {} failed: {}, creating a new one", self->_sessionId, response);
+				// the handles died with the session, their owners attach again from onDetached(), see attach()
+				std::vector<std::shared_ptr<PluginClient>> detached;
+				for (const auto& pair : self->_pluginClientMap) {
+					if (auto pluginClient = pair.second.lock()) {
+						detached.emplace_back(pluginClient);
+					}
+					self->_decodePool->remove(pair.first);
+				}
+				self->_pluginClientMap.clear();
+				self->_sessionId = -1;
+				self->_sessionStatus = SessionStatus::EXPIRED;
+				self->UniversalObservable<ISignalingClientObserver>::notifyObservers([](const auto& observer) {
+					observer->onSessionStatus(SessionStatus::EXPIRED);
+				});
+				self->_eventHandlerThread->PostTask(RTC_FROM_HERE, [detached]() {
+					for (const auto& pluginClient : detached) {
+						pluginClient->onCleanup(nullptr);
+						pluginClient->onDetached();
+					}
+				});
+				self->onOpened();
+			});
 		};
 		event->callback = std::make_shared<vi::EventCallback>(lambda);
 		createSession(event);
 	}
 
-	void SignalingClient::sendMessage(int64_t handleId, std::shared_ptr<MessageEvent> event)
+	void SignalingClient::onConnectionLost()
 	{
-		if (_sessionStatus == SessionStatus::CONNECTED) {
-			if (const auto& pluginClient = getHandler(handleId)) {
-				auto lambda = [wself = weak_from_this(), event](const std::string& json) {
-					DLOG("janus = {}", json);
-					if (auto self = wself.lock()) {
-						if (!event) {
-							return;
-						}
+		_connected = false;
+		if (_destroying || _sessionId == -1) {
+			return;
+		}
 
-						std::string err;
-						std::shared_ptr<JanusResponse> model = fromJsonString<JanusResponse>(json, err);
-						if (!err.empty()) {
-							DLOG("parse JanusResponse failed");
-							return;
-						}
+		if (!_recovering) {
+			WLOG("signaling connection lost, recovering session {}", _sessionId);
+			_recovering = true;
+			_connectionLostMs = rtc::TimeMillis();
+			_reconnectAttempts = 0;
+			stopHeartbeat();
+			_sessionStatus = SessionStatus::DISCONNECTED;
+			UniversalObservable<ISignalingClientObserver>::notifyObservers([](const auto& observer) {
+				observer->onSessionStatus(SessionStatus::DISCONNECTED);
+			});
+		}
+		scheduleReconnect();
+	}
 
-						if (event->callback) {
-							if (model->janus.value_or("") == "success" || model->janus.value_or("") == "ack") {
-								self->_eventHandlerThread->PostTask(RTC_FROM_HERE, [cb = event->callback, json]() {
-									if (cb) {
-										(*cb)(true, json);
-									}
-								});
-							}
-							else if (model->janus.value_or("") != "ack") {
-								self->_eventHandlerThread->PostTask(RTC_FROM_HERE, [cb = event->callback, json]() {
-									if (cb) {
-										(*cb)(false, json);
-									}
-								});
-							}
-						}
-					}
-				};
-				std::shared_ptr<JCCallback> callback = std::make_shared<JCCallback>(lambda);
-				_client->sendMessage(_sessionId, handleId, event->message, event->jsep, callback);
+	void SignalingClient::scheduleReconnect()
+	{
+		uint32_t delay = jitteredDelay(_reconnectAttempts++);
+		DLOG("reconnect attempt {} in {} ms", _reconnectAttempts, delay);
+		_reconnectTaskId = _heartbeatTaskScheduler->schedule([wself = weak_from_this()]() {
+			auto self = wself.lock();
+			if (!self || !self->_recovering || self->_destroying) {
+				return;
 			}
+			self->_client->connect(self->_server);
+		}, delay);
+	}
+
+	bool SignalingClient::canSend() const
+	{
+		return _sessionStatus == SessionStatus::CONNECTED || (_recovering && _sessionId != -1);
+	}
+
+	void SignalingClient::sendMessage(int64_t handleId, std::shared_ptr<MessageEvent> event)
+	{
+		if (canSend() && getHandler(handleId)) {
+			auto lambda = [wself = weak_from_this(), handleId, event](const std::string& json) {
+				DLOG("janus = {}", json);
+				auto self = wself.lock();
+				if (!self || !event || !event->callback) {
+					return;
+				}
+
+				JsonSaxResult result;
+				std::shared_ptr<JanusResponse> model = fromJsonStringSax<JanusResponse>(json, result);
+				if (!result.ok()) {
+					DLOG("parse JanusResponse failed, status: {}, key: {}", (int)result.status, result.key);
+				}
+				const bool success = result.ok() && (model->janus.value_or("") == "success" || model->janus.value_or("") == "ack");
+				// behind the events of the handle that arrived before the response
+				self->dispatch(handleId, nullptr, [cb = event->callback, success, json]() {
+					(*cb)(success, json);
+				});
+			};
+			std::shared_ptr<JCCallback> callback = std::make_shared<JCCallback>(lambda);
+			_client->sendMessage(_sessionId, handleId, event->message, event->jsep, event->coalesceKey, callback);
 		}
 		else {
 			if (event && event->callback) {
@@ -224,15 +332,30 @@ namespace vi {
 			return;
 		}
 
-		_eventHandlerThread->PostTask(RTC_FROM_HERE, [wself = weak_from_this(), handleId]() {
-			auto self = wself.lock();
-			if (!self) {
-				return;
-			}
-            if (const auto& pluginClient = self->getHandler(handleId)) {
-				pluginClient->onCleanup();
-			}
-		});
+		auto teardown = event ? event->teardown : nullptr;
+		if (!teardown) {
+			_eventHandlerThread->PostTask(RTC_FROM_HERE, [wself = weak_from_this(), handleId]() {
+				auto self = wself.lock();
+				if (!self) {
+					return;
+				}
+				if (const auto& pluginClient = self->getHandler(handleId)) {
+					pluginClient->onCleanup(nullptr);
+				}
+			});
+		}
+		else {
+			// expected here, before the teardown is started
+			auto cleaned = teardown->expect(TeardownPhase::CLOSE_PEER_CONNECTIONS);
+			_eventHandlerThread->PostTask(RTC_FROM_HERE, [wself = weak_from_this(), handleId, teardown, cleaned]() {
+				if (auto self = wself.lock()) {
+					if (const auto& pluginClient = self->getHandler(handleId)) {
+						pluginClient->onCleanup(teardown);
+					}
+				}
+				cleaned();
+			});
+		}
 
 		if (!event) {
 			return;
@@ -251,14 +374,19 @@ namespace vi {
 			return;
 		}
 
-		auto lambda = [wself = weak_from_this(), handleId](const std::string& json) {
+		auto detached = teardown ? teardown->expect(TeardownPhase::DETACH_HANDLES) : nullptr;
+		auto lambda = [wself = weak_from_this(), handleId, detached](const std::string& json) {
 			DLOG("janus = {}", json);
+			if (detached) {
+				detached();
+			}
 			auto self = wself.lock();
 			if (!self) {
 				return;
 			}
 
 			self->_pluginClientMap.erase(handleId);
+			self->_decodePool->remove(handleId);
 		};
 		std::shared_ptr<JCCallback> callback = std::make_shared<JCCallback>(lambda);
 		_client->detach(_sessionId, handleId, callback);
@@ -273,6 +401,14 @@ namespace vi {
 
 	void SignalingClient::onOpened()
 	{
+		if (_recovering && _sessionId != -1) {
+			reconnectSession();
+			return;
+		}
+
+		// a new session, nothing to claim first
+		_client->resume();
+
 		std::shared_ptr<CreateSessionEvent> event = std::make_shared<CreateSessionEvent>();
 		event->reconnect = false;
 		auto lambda = [wself = weak_from_this()](bool success, const std::string& response) {
@@ -286,58 +422,61 @@ namespace vi {
 
 	void SignalingClient::onClosed()
 	{
-		_connected = false;
+		onConnectionLost();
 	}	
 	
 	void SignalingClient::onFailed(int errorCode, const std::string& reason)
 	{
-		_connected = false;
+		onConnectionLost();
 	}
 
-	void SignalingClient::onMessage(const std::string& json)
+	void SignalingClient::onMessage(std::shared_ptr<const JanusMessage> message)
 	{
-		std::string err;
-		std::shared_ptr<JanusResponse> response = fromJsonString<JanusResponse>(json, err);
-		if (!err.empty()) {
-			DLOG("parse JanusResponse failed");
+		if (message->sessionId() != -1 && message->sessionId() != _sessionId) {
+			// a late event of a session that could not be claimed
+			return;
+		}
+
+		if (!message->hasSender()) {
+			DLOG("could not find 'sender' in message: {}", message->janus());
 			return;
 		}
 
-		int64_t sender = response->sender.value();
-        const auto& pluginClient = getHandler(sender);
+		int64_t sender = message->sender();
+		const auto& pluginClient = getHandler(sender);
 		if (!pluginClient) {
 			return;
 		}
 
 		auto wself = weak_from_this();
 
-		int32_t retries = 0;
+		const std::string& janus = message->janus();
 
-		if (response->janus.value_or("") == "keepalive") {
+		if (janus == "keepalive") {
 			DLOG("Got a keepalive on session: {}", _sessionId);
 		}
-		else if (response->janus.value_or("") == "server_info") {
+		else if (janus == "server_info") {
 			// Just info on the Janus instance
-			DLOG("Got info on the Janus instance: {}", response->janus.value_or(""));
+			DLOG("Got info on the Janus instance: {}", janus);
 		}
-		else if (response->janus.value_or("") == "trickle") {
-			DLOG("Got info on the Janus instance: {}", response->janus.value_or(""));
+		else if (janus == "trickle") {
+			DLOG("Got info on the Janus instance: {}", janus);
 
-			_eventHandlerThread->PostTask(RTC_FROM_HERE, [json, sender, wself]() {
+			dispatch(sender, message, [message, sender, wself]() {
 				auto self = wself.lock();
 				if (!self) {
 					return;
 				}
 				if (auto pluginClient = self->getHandler(sender)) {
-					pluginClient->onTrickle(json);
+					pluginClient->onTrickle(message);
 				}
 			});
 		}
-		else if (response->janus.value_or("") == "webrtcup") {
+		else if (janus == "webrtcup") {
 			// The PeerConnection with the server is up! Notify this
 			DLOG("Got a webrtcup event on session: {}", _sessionId);
 
-			_eventHandlerThread->PostTask(RTC_FROM_HERE, [sender, wself]() {
+			dispatch(sender, message, [sender, wself]() {
 				auto self = wself.lock();
 				if (!self) {
 					return;
@@ -347,18 +486,17 @@ namespace vi {
 				}
 			});
 		}
-		else if (response->janus.value_or("") == "hangup") {
+		else if (janus == "hangup") {
 			// A plugin asked the core to hangup a PeerConnection on one of our handles
 			DLOG("Got a hangup event on session: {}", _sessionId);
 
-			std::string err;
-			std::shared_ptr<HangupResponse> model = fromJsonString<HangupResponse>(json, err);
-			if (!err.empty()) {
-				DLOG("parse JanusResponse failed");
+			auto model = message->view<HangupResponse>();
+			if (!model) {
+				DLOG("parse HangupResponse failed");
 				return;
 			}
 
-			_eventHandlerThread->PostTask(RTC_FROM_HERE, [sender, wself, reason = model->reason.value_or("")]() {
+			dispatch(sender, message, [sender, wself, reason = model->reason.value_or("")]() {
 				auto self = wself.lock();
 				if (!self) {
 					return;
@@ -369,11 +507,11 @@ namespace vi {
 				}
 			});
 		}
-		else if (response->janus.value_or("") == "detached") {
+		else if (janus == "detached") {
 			// A plugin asked the core to detach one of our handles
 			DLOG("Got a detached event on session: {}", _sessionId);
 
-			_eventHandlerThread->PostTask(RTC_FROM_HERE, [sender, wself]() {
+			dispatch(sender, message, [sender, wself]() {
 				auto self = wself.lock();
 				if (!self) {
 					return;
@@ -383,18 +521,17 @@ namespace vi {
 				}
 			});
 		}
-		else if (response->janus.value_or("") == "media") {
+		else if (janus == "media") {
 			// Media started/stopped flowing
 			DLOG("Got a media event on session: {}", _sessionId);
 
-			std::string err;
-			std::shared_ptr<MediaResponse> model = fromJsonString<MediaResponse>(json, err);
-			if (!err.empty()) {
-				DLOG("parse JanusResponse failed");
+			auto model = message->view<MediaResponse>();
+			if (!model) {
+				DLOG("parse MediaResponse failed");
 				return;
 			}
 
-			_eventHandlerThread->PostTask(RTC_FROM_HERE, [sender, wself, model]() {
+			dispatch(sender, message, [sender, wself, model]() {
 				auto self = wself.lock();
 				if (!self) {
 					return;
@@ -405,17 +542,16 @@ namespace vi {
 				}
 			});
 		}
-		else if (response->janus.value_or("") == "slowlink") {
+		else if (janus == "slowlink") {
 			DLOG("Got a slowlink event on session: {}", _sessionId);
 
-			std::string err;
-			std::shared_ptr<SlowlinkResponse> model = fromJsonString<SlowlinkResponse>(json, err);
-			if (!err.empty()) {
-				DLOG("parse JanusResponse failed");
+			auto model = message->view<SlowlinkResponse>();
+			if (!model) {
+				DLOG("parse SlowlinkResponse failed");
 				return;
 			}
 
-			_eventHandlerThread->PostTask(RTC_FROM_HERE, [sender, wself, model]() {
+			dispatch(sender, message, [sender, wself, model]() {
 				auto self = wself.lock();
 				if (!self) {
 					return;
@@ -425,38 +561,29 @@ namespace vi {
 				}
 			});
 		}
-		else if (response->janus.value_or("") == "event") {
+		else if (janus == "event") {
 			DLOG("Got a plugin event on session: {}", _sessionId);
 
-			std::string err;
-			std::shared_ptr<JanusEvent> event = fromJsonString<JanusEvent>(json, err);
-			if (!err.empty()) {
-				DLOG("parse JanusResponse failed");
-				return;
-			}
-
-			if (!event->plugindata) {
+			if (!message->hasMember("plugindata")) {
 				ELOG("Missing plugindata...");
 				return;
 			}
-			
-			DLOG(" -- Event is coming from {} ({})", sender, event->plugindata->plugin.value_or(""));
 
-			std::string jsep = event->jsep ? event->jsep->toJsonStr() : "";
+			DLOG(" -- Event is coming from {}", sender);
 
-			_eventHandlerThread->PostTask(RTC_FROM_HERE, [sender, wself, json, jsep]() {
+			dispatch(sender, message, [sender, wself, message]() {
 				auto self = wself.lock();
 				if (!self) {
 					return;
 				}
 				if (auto pluginClient = self->getHandler(sender)) {
-					pluginClient->onMessage(json, jsep);
+					pluginClient->onMessage(message);
 				}
 			});
 		}
-		else if (response->janus.value_or("") == "timeout") {
+		else if (janus == "timeout") {
 			ELOG("Timeout on session: {}", _sessionId);
-			_eventHandlerThread->PostTask(RTC_FROM_HERE, [sender, wself]() {
+			dispatch(sender, message, [sender, wself]() {
 				auto self = wself.lock();
 				if (!self) {
 					return;
@@ -466,11 +593,11 @@ namespace vi {
 				}
 			});
 		}
-		else if (response->janus.value_or("") == "error") {
+		else if (janus == "error") {
 			// something wrong happened
-			DLOG("Something wrong happened: {}", response->janus.value_or(""));
+			DLOG("Something wrong happened: {}", janus);
 
-			_eventHandlerThread->PostTask(RTC_FROM_HERE, [sender, wself]() {
+			dispatch(sender, message, [sender, wself]() {
 				auto self = wself.lock();
 				if (!self) {
 					return;
@@ -481,22 +608,41 @@ namespace vi {
 			});
 		}
 		else {
-			WLOG("Unknown message/event {} on session: {}'", response->janus.value_or(""),  _sessionId);
+			WLOG("Unknown message/event {} on session: {}'", janus, _sessionId);
 		}
 	}
 
 	void SignalingClient::createSession(std::shared_ptr<CreateSessionEvent> event)
 	{
 		auto lambda = [wself = weak_from_this(), event](const std::string& json) {
-			std::string err;
-			std::shared_ptr<CreateSessionResponse> model = fromJsonString<CreateSessionResponse>(json, err);
-			if (!err.empty()) {
-				DLOG("parse JanusResponse failed");
+			JsonSaxResult result;
+			std::shared_ptr<CreateSessionResponse> model = fromJsonStringSax<CreateSessionResponse>(json, result);
+			if (!result.ok()) {
+				DLOG("parse CreateSessionResponse failed, status: {}, key: {}", (int)result.status, result.key);
+				// a claim waits for this to resume or start over
+				if (auto self = wself.lock()) {
+					if (event && event->callback) {
+						self->_eventHandlerThread->PostTask(RTC_FROM_HERE, [cb = event->callback, json]() {
+							(*cb)(false, json);
+						});
+					}
+				}
 				return;
 			}
 
 			DLOG("model.janus = {}", model->janus.value_or(""));
 			if (auto self = wself.lock()) {
+				// timed out or rejected transactions come back as a synthesized error
+				if (model->janus.value_or("") != "success" || (model->session_id.value_or(0) <= 0 && !model->data)) {
+					ELOG("create session failed: {}", json);
+					if (event && event->callback) {
+						self->_eventHandlerThread->PostTask(RTC_FROM_HERE, [cb = event->callback, json]() {
+							(*cb)(false, json);
+						});
+					}
+					return;
+				}
+
 				self->_sessionId = model->session_id.value_or(0) > 0 ? model->session_id.value() : model->data->id.value();
 				self->startHeartbeat();
 				self->_sessionStatus =SessionStatus::CONNECTED;
@@ -505,6 +651,14 @@ namespace vi {
 					observer->onSessionStatus(SessionStatus::CONNECTED);
 				});
 
+				auto pending = std::move(self->_pendingAttaches);
+				self->_pendingAttaches.clear();
+				for (const auto& item : pending) {
+					if (auto pluginClient = item.pluginClient.lock()) {
+						self->attach(item.plugin, item.opaqueId, pluginClient);
+					}
+				}
+
 				if (event && event->callback) {
 					self->_eventHandlerThread->PostTask(RTC_FROM_HERE, [cb = event->callback]() {
 						(*cb)(true, "");
@@ -521,8 +675,25 @@ namespace vi {
 		}
 	}
 
+	void SignalingClient::dispatch(int64_t handleId, std::shared_ptr<const JanusMessage> message, std::function<void()> task)
+	{
+		std::weak_ptr<PluginClient> wpc = getHandler(handleId);
+		_decodePool->post(handleId, [wself = weak_from_this(), wpc, message, task]() {
+			if (auto pluginClient = wpc.lock()) {
+				if (message) {
+					pluginClient->decode(message);
+				}
+			}
+			// posted from the strand, so the events and responses of a handle reach plugin-client thread in order
+			if (auto self = wself.lock()) {
+				self->_eventHandlerThread->PostTask(RTC_FROM_HERE, task);
+			}
+		});
+	}
+
 	void SignalingClient::startHeartbeat()
 	{
+		stopHeartbeat();
 		_heartbeatTaskId = _heartbeatTaskScheduler->schedule([wself = weak_from_this()]() {
 			if (auto self = wself.lock()) {
 				DLOG("sessionHeartbeat() called");
@@ -535,6 +706,13 @@ namespace vi {
 		}, 5000, true);
 	}
 
+	void SignalingClient::stopHeartbeat()
+	{
+		if (_heartbeatTaskScheduler) {
+			_heartbeatTaskScheduler->cancel(_heartbeatTaskId);
+		}
+	}
+
 	std::shared_ptr<PluginClient> SignalingClient::getHandler(int64_t handleId)
 	{
 		if (handleId == -1) {
@@ -550,22 +728,36 @@ namespace vi {
 
 	void SignalingClient::sendTrickleCandidate(int64_t handleId, std::shared_ptr<TrickleCandidateEvent> event)
 	{
-		auto lambda = [wself = weak_from_this(), event](const std::string& json) {
+		if (!canSend()) {
+			DLOG("service down, trickle dropped");
+			return;
+		}
+		auto lambda = [wself = weak_from_this(), handleId, event](const std::string& json) {
 			if (auto self = wself.lock()) {
 				if (event && event->callback) {
-					self->_eventHandlerThread->PostTask(RTC_FROM_HERE, [cb = event->callback, json]() {
+					self->dispatch(handleId, nullptr, [cb = event->callback, json]() {
 						(*cb)(true, json);
 					});
 				}
 			}
 		};
 		std::shared_ptr<JCCallback> callback = std::make_shared<JCCallback>(lambda);
-		_client->sendTrickleCandidate(_sessionId, handleId, event->candidate, callback);
+		if (!event->candidates.empty()) {
+			_client->sendTrickleCandidates(_sessionId, handleId, event->candidates, callback);
+		}
+		else {
+			_client->sendTrickleCandidate(_sessionId, handleId, event->candidate, callback);
+		}
 	}
 
 	void SignalingClient::destroySession(std::shared_ptr<DestroySessionEvent> event)
 	{
 		DLOG("Destroying session: {}", _sessionId);
+		_destroying = true;
+		_pendingAttaches.clear();
+		if (_heartbeatTaskScheduler) {
+			_heartbeatTaskScheduler->cancel(_reconnectTaskId);
+		}
 		if (_sessionId == -1) {
 			DLOG("No session to destroy");
 			if (event && event->callback) {
@@ -581,10 +773,20 @@ namespace vi {
 		if (!event) {
 			return;
 		}
+		// the handles and the session go down in parallel, |event->callback| is called once all
+		// of it is done or at the deadline
+		auto teardown = TeardownCoordinator::create(_signalingThread, _threads->closePool(), event->deadlineMs, [thread = _eventHandlerThread, cb = event->callback](const TeardownReport& report) {
+			if (cb) {
+				thread->PostTask(RTC_FROM_HERE, [cb, timedOut = report.timedOut]() {
+					(*cb)(!timedOut, timedOut ? "teardown timed out" : "");
+				});
+			}
+		});
 		if (event->cleanupHandles) {
 			for (auto pair : _pluginClientMap) {
 				std::shared_ptr<DetachEvent> de = std::make_shared<DetachEvent>();
 				de->noRequest = true;
+				de->teardown = teardown;
 				int64_t hId = pair.first;
 				auto lambda = [hId](bool success, const std::string& response) {
 					DLOG("destroyHandle, handleId = {}, success = {}, response = {}", hId, success, response.c_str());
@@ -597,23 +799,20 @@ namespace vi {
 		}
 		if (!_connected) {
 			DLOG("Is the server down? (connected = false)");
-			if(event->callback) {
-				//_eventHandlerThread->PostTask(RTC_FROM_HERE, [cb = event->callback]() {
-				const auto& cb = event->callback;
-				(*cb)(true, "");
-				//});
-			}
+			teardown->start();
 			return;
 		}
 
-		// TODO: destroy session from janus 
-		auto lambda = [wself = weak_from_this()](const std::string& json) {
+		auto destroyed = teardown->expect(TeardownPhase::DESTROY_SESSION);
+		auto lambda = [wself = weak_from_this(), destroyed](const std::string& json) {
 			DLOG("janus = {}", json);
+			destroyed();
 			if (auto self = wself.lock()) {
 				self->_client->removeListener(self);
 			}
 		};
 		std::shared_ptr<JCCallback> callback = std::make_shared<JCCallback>(lambda);
 		_client->destroySession(_sessionId, callback);
+		teardown->start();
 	}
 }
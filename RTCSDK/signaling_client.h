@@ -7,6 +7,7 @@
 #pragma once
 
 #include <memory>
+#include <functional>
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -27,6 +28,9 @@ namespace vi {
 	class TaskScheduler;
 	class CapturerTrackSource;
 	class PluginClient;
+	class StrandPool;
+	class ThreadProvider;
+	class WebsocketEndpoint;
 	class SignalingClient
 		: public SignalingClientInterface
 		, public ISfuApiClientListener
@@ -34,7 +38,8 @@ namespace vi {
 		, public std::enable_shared_from_this<SignalingClient>
 	{
 	public:
-		SignalingClient();
+		// The websocket runs on |websocket| if given, e.g. WebsocketEndpoint::shared(), otherwise on an endpoint of its own.
+		explicit SignalingClient(std::shared_ptr<ThreadProvider> threads, std::shared_ptr<WebsocketEndpoint> websocket = nullptr);
 
 		~SignalingClient() override;
 
@@ -48,6 +53,10 @@ namespace vi {
 
 		SessionStatus sessionStatus() override;
 
+		LatencyHistogram::Snapshot recoveryLatency() override;
+
+		LatencyHistogram::Snapshot decodeQueueLatency(int64_t handleId) override;
+
 		void connect(const std::string& url) override;
 
 	protected:
@@ -73,7 +82,7 @@ namespace vi {
 
 		void onFailed(int errorCode, const std::string& reason) override;
 
-		void onMessage(const std::string& json) override;
+		void onMessage(std::shared_ptr<const JanusMessage> message) override;
 
 	private:
 
@@ -84,12 +93,25 @@ namespace vi {
 
 		void reconnectSession();
 
+		void onConnectionLost();
+
+		void scheduleReconnect();
+
+		void stopHeartbeat();
+
 		void destroySession(std::shared_ptr<DestroySessionEvent> event);
 
 		void startHeartbeat();
 
+		// Decodes |message|, if any, on the strand of |handleId|, then runs |task| in plugin-client thread.
+		// The responses to requests of a handle go this way too, so they never overtake its events.
+		void dispatch(int64_t handleId, std::shared_ptr<const JanusMessage> message, std::function<void()> task);
+
 		std::shared_ptr<PluginClient> getHandler(int64_t handleId);
 
+		// Connected, or recovering with the requests held in the send queue until the session is claimed.
+		bool canSend() const;
+
 	private:
 		std::string _server;	
 
@@ -113,7 +135,40 @@ namespace vi {
 
 		SessionStatus _sessionStatus = SessionStatus::DISCONNECTED;
 
+		// set while the connection is being re-established for an existing session
+		bool _recovering = false;
+
+		// set once the session is being destroyed on purpose, no reconnect then
+		bool _destroying = false;
+
+		uint32_t _reconnectAttempts = 0;
+
+		int64_t _connectionLostMs = 0;
+
+		uint64_t _reconnectTaskId = 0;
+
+		LatencyHistogram _recoveryLatency;
+
+		struct PendingAttach {
+			std::string plugin;
+			std::string opaqueId;
+			std::weak_ptr<PluginClient> pluginClient;
+		};
+
+		// asked for while an expired session is being replaced, sent once the new one is created
+		std::vector<PendingAttach> _pendingAttaches;
+
+		// threads of the engine this client belongs to
+		std::shared_ptr<ThreadProvider> _threads;
+
+		std::shared_ptr<WebsocketEndpoint> _websocket;
+
 		rtc::Thread* _eventHandlerThread;
+
+		rtc::Thread* _signalingThread = nullptr;
+
+		// events of a handle are decoded in order on their own strand, handles in parallel
+		std::unique_ptr<StrandPool> _decodePool;
 	};
 }
 
@@ -12,6 +12,7 @@
 #include "service/i_unified_factory.h"
 #include "signaling_client_status.h"
 #include "weak_proxy.h"
+#include "utils/latency_histogram.h"
 
 namespace vi {
 	class PluginClient;
@@ -31,6 +32,12 @@ namespace vi {
 
 		virtual SessionStatus sessionStatus() = 0;
 
+		// Time from losing the signaling connection to having the session claimed again.
+		virtual LatencyHistogram::Snapshot recoveryLatency() = 0;
+
+		// Time the events of |handleId| waited for a decode worker.
+		virtual LatencyHistogram::Snapshot decodeQueueLatency(int64_t handleId) = 0;
+
 		virtual void connect(const std::string& url) = 0;
 
 		virtual void attach(const std::string& plugin, const std::string& opaqueId, std::shared_ptr<PluginClient> pluginClient) = 0;
@@ -54,6 +61,8 @@ namespace vi {
 		WEAK_PROXY_METHOD1(void, unregisterObserver, std::shared_ptr<ISignalingClientObserver>)
 		WEAK_PROXY_METHOD1(void, connect, const std::string&)
 		WEAK_PROXY_METHOD0(SessionStatus, sessionStatus)
+		WEAK_PROXY_METHOD0(LatencyHistogram::Snapshot, recoveryLatency)
+		WEAK_PROXY_METHOD1(LatencyHistogram::Snapshot, decodeQueueLatency, int64_t)
 		WEAK_PROXY_METHOD3(void, attach, const std::string&, const std::string&, std::shared_ptr<PluginClient>)
 		WEAK_PROXY_METHOD1(void, destroy, std::shared_ptr<DestroySessionEvent>)
 		WEAK_PROXY_METHOD2(void, sendMessage, int64_t, std::shared_ptr<MessageEvent>)
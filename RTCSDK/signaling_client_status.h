@@ -5,6 +5,8 @@
 namespace vi {
 	enum class SessionStatus : uint32_t {
 		CONNECTED = 0,
-		DISCONNECTED
+		DISCONNECTED,
+		// the session could not be claimed after a reconnect, its handles are gone and a new one is created
+		EXPIRED
 	};
 }
\ No newline at end of file
@@ -12,8 +12,11 @@
 #include "api/media_stream_interface.h"
 #include "absl/types/optional.h"
 #include "message_models.h"
+#include "video_layer.h"
 
 namespace vi {
+	class TeardownCoordinator;
+
 	using SuccessCallback = std::function<void()>;
 	using FailureCallback = std::function<void(const std::string& reason)>;
 	using EventCallback = std::function<void(bool success, const std::string& response)>;
@@ -29,11 +32,15 @@ namespace vi {
 	public:
 		std::string message;
 		std::string jsep;
+		// set by senders of requests a later one can supersede, e.g. "configure:<mid>:substream:temporal"
+		std::string coalesceKey;
 	};
 
 	class TrickleCandidateEvent : public EventBase {
 	public:
 		CandidateData candidate;
+		// when not empty, sent as one trickle request with a "candidates" array instead of |candidate|
+		std::vector<CandidateData> candidates;
 	};
 
 	class ChannelDataEvent : public EventBase {
@@ -77,6 +84,9 @@ namespace vi {
 
 		absl::optional<bool> failIfNoAudio;
 		absl::optional<bool> failIfNoVideo;
+
+		// encodings of the published video track, a single plain one when empty
+		std::vector<VideoLayer> videoLayers;
 	};				   
 
 	struct JsepConfig {
@@ -90,7 +100,9 @@ namespace vi {
 		absl::optional<JsepConfig> jsep;
 		absl::optional<MediaConfig> media;
 		absl::optional<bool> trickle;
+		// ssrc based simulcast munged into the local SDP, ignored when |media| has video layers
 		absl::optional<bool> simulcast;
+		// rid based simulcast with VideoLayer::defaultSimulcast(), when |media| has no video layers
 		absl::optional<bool> simulcast2;
 		absl::optional<bool> iceRestart;
 		rtc::scoped_refptr<webrtc::MediaStreamInterface> stream;
@@ -103,8 +115,10 @@ namespace vi {
 
 	class DetachEvent : public EventBase {
 	public:
-		bool noRequest;
+		bool noRequest = false;
 		std::string jsep;
+		// set when the handle goes down together with others, see TeardownCoordinator
+		std::shared_ptr<TeardownCoordinator> teardown;
 	};
 
 	class CreateSessionEvent : public EventBase {
@@ -114,7 +128,9 @@ namespace vi {
 
 	class DestroySessionEvent : public EventBase {
 	public:
-		bool notifyDestroyed;
-		bool cleanupHandles;
+		bool notifyDestroyed = false;
+		bool cleanupHandles = false;
+		// |callback| is called once the session and its handles are down, or after this at the latest
+		uint32_t deadlineMs = 3000;
 	};
 }
\ No newline at end of file
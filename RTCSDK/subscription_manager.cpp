@@ -0,0 +1,147 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#include "subscription_manager.h"
+#include <algorithm>
+#include <iterator>
+#include "utils/task_scheduler.h"
+#include "logger/logger.h"
+
+namespace vi {
+
+	SubscriptionManager::SubscriptionManager(rtc::Thread* thread, Sender sender, uint32_t coalesceMs)
+		: _scheduler(TaskScheduler::create(thread))
+		, _sender(std::move(sender))
+		, _coalesceMs(coalesceMs)
+	{
+
+	}
+
+	SubscriptionManager::~SubscriptionManager()
+	{
+		_scheduler->cancelAll();
+	}
+
+	void SubscriptionManager::set(int64_t feed, const std::vector<std::string>& mids)
+	{
+		_failures = 0;
+		erase(_desired, feed);
+		for (const auto& mid : mids) {
+			_desired.insert(Stream{ feed, mid });
+		}
+		scheduleFlush();
+	}
+
+	void SubscriptionManager::remove(int64_t feed)
+	{
+		_failures = 0;
+		erase(_desired, feed);
+		scheduleFlush();
+	}
+
+	void SubscriptionManager::forget(int64_t feed)
+	{
+		erase(_desired, feed);
+		erase(_subscribed, feed);
+		if (_inFlight) {
+			_forgotten.insert(feed);
+		}
+	}
+
+	void SubscriptionManager::flush()
+	{
+		if (_flushTaskId != 0) {
+			_scheduler->cancel(_flushTaskId);
+			_flushTaskId = 0;
+		}
+		if (_inFlight) {
+			// sent again by acknowledge()
+			return;
+		}
+
+		std::vector<Stream> subscribe;
+		std::set_difference(_desired.begin(), _desired.end(), _subscribed.begin(), _subscribed.end(), std::back_inserter(subscribe));
+		std::vector<Stream> unsubscribe;
+		std::set_difference(_subscribed.begin(), _subscribed.end(), _desired.begin(), _desired.end(), std::back_inserter(unsubscribe));
+		if (subscribe.empty() && unsubscribe.empty()) {
+			return;
+		}
+
+		DLOG("subscription update, subscribe: {}, unsubscribe: {}", subscribe.size(), unsubscribe.size());
+		if (_sender && _sender(subscribe, unsubscribe)) {
+			_inFlight = true;
+			_sentSubscribe = std::move(subscribe);
+			_sentUnsubscribe = std::move(unsubscribe);
+		}
+	}
+
+	void SubscriptionManager::acknowledge(bool success)
+	{
+		if (!_inFlight) {
+			return;
+		}
+		_inFlight = false;
+
+		if (success) {
+			_failures = 0;
+			for (const auto& stream : _sentUnsubscribe) {
+				_subscribed.erase(stream);
+			}
+			for (const auto& stream : _sentSubscribe) {
+				if (_forgotten.find(stream.feed) == _forgotten.end()) {
+					_subscribed.insert(stream);
+				}
+			}
+		}
+		_forgotten.clear();
+		_sentSubscribe.clear();
+		_sentUnsubscribe.clear();
+
+		if (!success && ++_failures >= kMaxRetries) {
+			WLOG("subscription update failed {} times, waiting for the next change", _failures);
+			_failures = 0;
+			return;
+		}
+		// whatever changed meanwhile, or the failed diff once more
+		if (_desired != _subscribed) {
+			scheduleFlush();
+		}
+	}
+
+	void SubscriptionManager::reset()
+	{
+		_inFlight = false;
+		_failures = 0;
+		_forgotten.clear();
+		_sentSubscribe.clear();
+		_sentUnsubscribe.clear();
+		_subscribed.clear();
+	}
+
+	void SubscriptionManager::scheduleFlush()
+	{
+		if (_flushTaskId != 0) {
+			return;
+		}
+		// the window opens with the first change, later ones ride along
+		_flushTaskId = _scheduler->schedule([wself = weak_from_this()]() {
+			if (auto self = wself.lock()) {
+				self->_flushTaskId = 0;
+				self->flush();
+			}
+		}, _coalesceMs);
+	}
+
+	void SubscriptionManager::erase(std::set<Stream>& streams, int64_t feed)
+	{
+		auto first = streams.lower_bound(Stream{ feed, std::string() });
+		auto last = first;
+		while (last != streams.end() && last->feed == feed) {
+			++last;
+		}
+		streams.erase(first, last);
+	}
+}
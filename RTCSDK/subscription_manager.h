@@ -0,0 +1,94 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace rtc {
+	class Thread;
+}
+
+namespace vi {
+	class TaskScheduler;
+
+	// The feed/mid pairs a subscriber should receive. Changes made within |coalesceMs| are diffed against
+	// what is subscribed and handed over at once, so a burst of joins and leaves costs one renegotiation.
+	// One update is in flight at a time, later changes wait for its renegotiation to be acknowledged.
+	// Not thread safe, it is used from the thread of its subscriber.
+	class SubscriptionManager : public std::enable_shared_from_this<SubscriptionManager>
+	{
+	public:
+		struct Stream {
+			int64_t feed = 0;
+			std::string mid;
+
+			bool operator<(const Stream& other) const { return feed != other.feed ? feed < other.feed : mid < other.mid; }
+		};
+
+		// Sends the diff, false if it could not be sent yet, it is kept then until the next flush().
+		// Once sent, the outcome is reported back through acknowledge().
+		using Sender = std::function<bool(const std::vector<Stream>& subscribe, const std::vector<Stream>& unsubscribe)>;
+
+		SubscriptionManager(rtc::Thread* thread, Sender sender, uint32_t coalesceMs = 200);
+
+		~SubscriptionManager();
+
+		// The streams of |feed| to receive, replacing the ones it had
+		void set(int64_t feed, const std::vector<std::string>& mids);
+
+		void remove(int64_t feed);
+
+		// |feed| is gone on Janus, which dropped its streams already, nothing is sent for them
+		void forget(int64_t feed);
+
+		// Sends the pending diff now, unless an update is in flight
+		void flush();
+
+		// The update in flight was answered and its renegotiation acknowledged, or it failed. It is
+		// committed on |success|, otherwise the streams it did not apply are sent again.
+		void acknowledge(bool success);
+
+		// The handle is gone and so are its subscriptions, everything desired is sent again once it is back
+		void reset();
+
+	private:
+		void scheduleFlush();
+
+		void erase(std::set<Stream>& streams, int64_t feed);
+
+		// max. failed updates in a row before waiting for the next change
+		static const uint32_t kMaxRetries = 3;
+
+	private:
+		std::shared_ptr<TaskScheduler> _scheduler;
+
+		Sender _sender;
+
+		uint32_t _coalesceMs;
+
+		uint64_t _flushTaskId = 0;
+
+		std::set<Stream> _desired;
+
+		std::set<Stream> _subscribed;
+
+		bool _inFlight = false;
+
+		std::vector<Stream> _sentSubscribe;
+
+		std::vector<Stream> _sentUnsubscribe;
+
+		// feeds gone on Janus while an update was in flight, whatever it subscribed of them is gone too
+		std::set<int64_t> _forgotten;
+
+		uint32_t _failures = 0;
+	};
+}
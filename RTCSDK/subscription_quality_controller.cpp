@@ -0,0 +1,134 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#include "subscription_quality_controller.h"
+#include <algorithm>
+#include "i_video_room_api.h"
+#include "video_room_models.h"
+#include "utils/task_scheduler.h"
+#include "logger/logger.h"
+
+namespace vi {
+	namespace {
+		// heights of the quarter and half resolution layers of a 720p publisher, see VideoLayer::defaultSimulcast()
+		const int kLowLayerHeight = 180;
+		const int kMediumLayerHeight = 360;
+
+		// below this views get 15 fps instead of 30
+		const int kReducedFramerateHeight = 120;
+	}
+
+	SubscriptionQualityController::SubscriptionQualityController(std::shared_ptr<IVideoRoomApi> api, rtc::Thread* thread, uint32_t debounceMs)
+		: _api(api)
+		, _scheduler(TaskScheduler::create(thread))
+		, _debounceMs(debounceMs)
+	{
+
+	}
+
+	SubscriptionQualityController::~SubscriptionQualityController()
+	{
+		_scheduler->cancelAll();
+	}
+
+	SubscriptionQualityController::Target SubscriptionQualityController::targetFor(int width, int height)
+	{
+		Target target;
+		if (width <= 0 || height <= 0) {
+			target.substream = 0;
+			target.temporal = 0;
+			return target;
+		}
+
+		// the height the view would have at 16:9, so that wide and tall views compare alike
+		const int size = std::max(height, width * 9 / 16);
+		if (size <= kLowLayerHeight) {
+			target.substream = 0;
+		}
+		else if (size <= kMediumLayerHeight) {
+			target.substream = 1;
+		}
+		else {
+			target.substream = 2;
+		}
+		target.temporal = size <= kReducedFramerateHeight ? 1 : 2;
+		return target;
+	}
+
+	void SubscriptionQualityController::setViewSize(const std::string& mid, int width, int height)
+	{
+		const auto target = targetFor(width, height);
+		auto& stream = _streams[mid];
+		if (stream.target == target && stream.sent) {
+			return;
+		}
+		stream.target = target;
+		scheduleFlush(_debounceMs);
+	}
+
+	void SubscriptionQualityController::setVisible(const std::string& mid, bool visible)
+	{
+		auto& stream = _streams[mid];
+		if (stream.visible == visible) {
+			return;
+		}
+		stream.visible = visible;
+		scheduleFlush(visible ? 0 : _debounceMs);
+	}
+
+	void SubscriptionQualityController::remove(const std::string& mid)
+	{
+		_streams.erase(mid);
+	}
+
+	void SubscriptionQualityController::scheduleFlush(uint32_t delayMs)
+	{
+		if (_flushTaskId != 0) {
+			_scheduler->cancel(_flushTaskId);
+		}
+		_flushTaskId = _scheduler->schedule([wself = weak_from_this()]() {
+			if (auto self = wself.lock()) {
+				self->_flushTaskId = 0;
+				self->flush();
+			}
+		}, delayMs);
+	}
+
+	void SubscriptionQualityController::flush()
+	{
+		auto api = _api.lock();
+		if (!api) {
+			DLOG("invalid video room api");
+			return;
+		}
+
+		for (auto& item : _streams) {
+			auto& stream = item.second;
+			const bool targetChanged = !stream.sent || *stream.sent != stream.target;
+			const bool visibilityChanged = stream.sentVisible != stream.visible;
+			if (!targetChanged && !visibilityChanged) {
+				continue;
+			}
+
+			auto request = std::make_shared<vr::SubscriberConfigureRequest>();
+			request->mid = item.first;
+			if (targetChanged) {
+				request->substream = stream.target.substream;
+				request->temporal = stream.target.temporal;
+			}
+			// unset fields are left alone by Janus
+			request->send = visibilityChanged ? absl::optional<bool>(stream.visible) : absl::nullopt;
+			request->restart = absl::nullopt;
+
+			DLOG("configure mid: {}, substream: {}, temporal: {}, send: {}", item.first, stream.target.substream, stream.target.temporal, stream.visible ? "yes" : "no");
+			api->subscriberConfigure(request, [mid = item.first](std::shared_ptr<JanusResponse> response) {
+				DLOG("configure mid: {}, response: {}", mid, response ? response->janus.value_or("") : "none");
+			});
+			stream.sent = stream.target;
+			stream.sentVisible = stream.visible;
+		}
+	}
+}
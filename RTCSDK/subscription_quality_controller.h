@@ -0,0 +1,78 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "absl/types/optional.h"
+
+namespace rtc {
+	class Thread;
+}
+
+namespace vi {
+	class IVideoRoomApi;
+	class TaskScheduler;
+
+	// Picks the simulcast substream and temporal layer of every subscribed video from the size it is
+	// rendered at, and asks Janus for them with a "configure" once the sizes settle. Videos that are
+	// not visible are paused with "send": false.
+	// Not thread safe, it is used from the thread of its subscriber.
+	class SubscriptionQualityController : public std::enable_shared_from_this<SubscriptionQualityController>
+	{
+	public:
+		struct Target {
+			int64_t substream = 2;
+			int64_t temporal = 2;
+
+			bool operator==(const Target& other) const { return substream == other.substream && temporal == other.temporal; }
+
+			bool operator!=(const Target& other) const { return !(*this == other); }
+		};
+
+		// Requests go through |api|, from |thread|, |debounceMs| after the last size that changed a target.
+		SubscriptionQualityController(std::shared_ptr<IVideoRoomApi> api, rtc::Thread* thread, uint32_t debounceMs = 300);
+
+		~SubscriptionQualityController();
+
+		// |width| x |height| is the size in pixels of the view |mid| is rendered in
+		void setViewSize(const std::string& mid, int width, int height);
+
+		// Hiding is debounced like sizes, showing is sent right away. Janus asks the publisher for a
+		// keyframe itself when it starts relaying again.
+		void setVisible(const std::string& mid, bool visible);
+
+		void remove(const std::string& mid);
+
+		static Target targetFor(int width, int height);
+
+	private:
+		void scheduleFlush(uint32_t delayMs);
+
+		void flush();
+
+	private:
+		struct Stream {
+			Target target;
+			absl::optional<Target> sent;
+			bool visible = true;
+			// Janus relays every stream until told otherwise
+			bool sentVisible = true;
+		};
+
+		std::weak_ptr<IVideoRoomApi> _api;
+
+		std::shared_ptr<TaskScheduler> _scheduler;
+
+		uint32_t _debounceMs;
+
+		uint64_t _flushTaskId = 0;
+
+		std::unordered_map<std::string, Stream> _streams;
+	};
+}
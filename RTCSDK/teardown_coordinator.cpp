@@ -0,0 +1,136 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#include "teardown_coordinator.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+#include "logger/logger.h"
+#include "utils/strand_pool.h"
+#include "utils/task_scheduler.h"
+
+namespace vi {
+	std::shared_ptr<TeardownCoordinator> TeardownCoordinator::create(rtc::Thread* thread, std::shared_ptr<StrandPool> closePool, uint32_t deadlineMs, Completion completion)
+	{
+		return std::shared_ptr<TeardownCoordinator>(new TeardownCoordinator(thread, std::move(closePool), deadlineMs, std::move(completion)));
+	}
+
+	TeardownCoordinator::TeardownCoordinator(rtc::Thread* thread, std::shared_ptr<StrandPool> closePool, uint32_t deadlineMs, Completion completion)
+		: _thread(thread)
+		, _deadlineMs(deadlineMs)
+		, _completion(std::move(completion))
+		, _createdMs(rtc::TimeMillis())
+		, _closePool(std::move(closePool))
+	{
+	}
+
+	TeardownCoordinator::~TeardownCoordinator()
+	{
+		DLOG("~TeardownCoordinator()");
+	}
+
+	std::function<void()> TeardownCoordinator::expect(TeardownPhase phase)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			++_pending[(size_t)phase];
+		}
+		// holds the coordinator, a step that is never done keeps it until the deadline
+		return [self = shared_from_this(), phase]() {
+			self->done(phase);
+		};
+	}
+
+	void TeardownCoordinator::closePeerConnection(rtc::scoped_refptr<webrtc::PeerConnectionInterface> pc)
+	{
+		if (!pc) {
+			return;
+		}
+		auto closed = expect(TeardownPhase::CLOSE_PEER_CONNECTIONS);
+		if (!_closePool) {
+			pc->Close();
+			closed();
+			return;
+		}
+		int64_t key = 0;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			key = (int64_t)(_closeCount++ % kCloseStrands);
+		}
+		_closePool->post(key, [pc, closed]() {
+			pc->Close();
+			closed();
+		});
+	}
+
+	void TeardownCoordinator::start()
+	{
+		_deadlineScheduler = TaskScheduler::create(_thread);
+		_deadlineScheduler->schedule([self = shared_from_this()]() {
+			self->complete(true);
+		}, _deadlineMs);
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_started = true;
+		completeIfDone();
+	}
+
+	void TeardownCoordinator::done(TeardownPhase phase)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		size_t index = (size_t)phase;
+		if (_pending[index] == 0) {
+			return;
+		}
+		if (--_pending[index] == 0) {
+			_doneMs[index] = rtc::TimeMillis() - _createdMs;
+		}
+		completeIfDone();
+	}
+
+	void TeardownCoordinator::completeIfDone()
+	{
+		if (!_started || _completed) {
+			return;
+		}
+		for (size_t pending : _pending) {
+			if (pending != 0) {
+				return;
+			}
+		}
+		_thread->PostTask(RTC_FROM_HERE, [self = shared_from_this()]() {
+			self->complete(false);
+		});
+	}
+
+	void TeardownCoordinator::complete(bool timedOut)
+	{
+		TeardownReport report;
+		Completion completion;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (_completed) {
+				return;
+			}
+			_completed = true;
+			for (size_t i = 0; i < kPhases; ++i) {
+				report.phaseMs[i] = _pending[i] == 0 ? _doneMs[i] : -1;
+			}
+			report.totalMs = rtc::TimeMillis() - _createdMs;
+			report.timedOut = timedOut;
+			completion = std::move(_completion);
+		}
+		if (_deadlineScheduler) {
+			_deadlineScheduler->cancelAll();
+		}
+
+		DLOG("teardown {} in {} ms, close peer connections: {} ms, detach handles: {} ms, destroy session: {} ms",
+			timedOut ? "timed out" : "done", report.totalMs, report.phaseMs[0], report.phaseMs[1], report.phaseMs[2]);
+
+		if (completion) {
+			completion(report);
+		}
+	}
+}
@@ -0,0 +1,103 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "api/peer_connection_interface.h"
+
+namespace rtc {
+	class Thread;
+}
+
+namespace vi {
+	class StrandPool;
+	class TaskScheduler;
+
+	enum class TeardownPhase {
+		CLOSE_PEER_CONNECTIONS = 0,
+		DETACH_HANDLES,
+		DESTROY_SESSION
+	};
+
+	struct TeardownReport {
+		// milliseconds from the creation of the coordinator until the last step of each phase
+		// was done, 0 for a phase without steps and -1 for one cut off by the deadline
+		std::array<int64_t, 3> phaseMs{ { 0, 0, 0 } };
+
+		int64_t totalMs = 0;
+
+		bool timedOut = false;
+	};
+
+	// Tears a session, or some handles of it, down in parallel: the PeerConnections are closed on the
+	// close pool of the engine and every request goes out at once, the steps are only counted. Completes
+	// once all steps are done or at the deadline, whichever comes first, so a dead gateway can't
+	// hold the caller.
+	class TeardownCoordinator : public std::enable_shared_from_this<TeardownCoordinator>
+	{
+	public:
+		using Completion = std::function<void(const TeardownReport& report)>;
+
+		// |completion| runs once, on |thread|. PeerConnections are closed on |closePool|, see ThreadProvider::closePool().
+		static std::shared_ptr<TeardownCoordinator> create(rtc::Thread* thread, std::shared_ptr<StrandPool> closePool, uint32_t deadlineMs, Completion completion);
+
+		~TeardownCoordinator();
+
+		// One more step of |phase| to wait for, the returned function (callable from any thread)
+		// marks it done. Steps must be expected before start(), or by a step still pending.
+		std::function<void()> expect(TeardownPhase phase);
+
+		// Closes |pc| on the close pool, as a step of CLOSE_PEER_CONNECTIONS.
+		void closePeerConnection(rtc::scoped_refptr<webrtc::PeerConnectionInterface> pc);
+
+		// All the first steps are expected, arms the deadline.
+		void start();
+
+	private:
+		TeardownCoordinator(rtc::Thread* thread, std::shared_ptr<StrandPool> closePool, uint32_t deadlineMs, Completion completion);
+
+		void done(TeardownPhase phase);
+
+		// Called with |_mutex| held.
+		void completeIfDone();
+
+		void complete(bool timedOut);
+
+	private:
+		static constexpr size_t kPhases = 3;
+
+		// strands of the close pool a coordinator spreads its PeerConnections over
+		static constexpr size_t kCloseStrands = 4;
+
+		rtc::Thread* _thread;
+
+		uint32_t _deadlineMs;
+
+		Completion _completion;
+
+		int64_t _createdMs;
+
+		std::mutex _mutex;
+
+		std::array<size_t, kPhases> _pending{};
+
+		std::array<int64_t, kPhases> _doneMs{};
+
+		bool _started = false;
+
+		bool _completed = false;
+
+		size_t _closeCount = 0;
+
+		std::shared_ptr<StrandPool> _closePool;
+
+		std::shared_ptr<TaskScheduler> _deadlineScheduler;
+	};
+}
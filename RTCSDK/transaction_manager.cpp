@@ -0,0 +1,308 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#include "transaction_manager.h"
+#include <algorithm>
+#include <functional>
+#include "rtc_base/time_utils.h"
+#include "utils/task_scheduler.h"
+#include "logger/logger.h"
+
+namespace vi {
+	namespace {
+		size_t roundUpPowerOfTwo(size_t value)
+		{
+			size_t result = 16;
+			while (result < value) {
+				result <<= 1;
+			}
+			return result;
+		}
+	}
+
+	TransactionManager::TransactionManager(size_t capacity, uint32_t tickMs)
+		: _mask(roundUpPowerOfTwo(capacity) - 1)
+		, _tickMs(tickMs > 0 ? tickMs : 100)
+		, _entries(_mask + 1)
+	{
+		_currentTick = rtc::TimeMillis() / _tickMs;
+	}
+
+	TransactionManager::~TransactionManager()
+	{
+		DLOG("~TransactionManager()");
+		stop();
+	}
+
+	void TransactionManager::start()
+	{
+		if (_tickScheduler) {
+			return;
+		}
+		_tickScheduler = TaskScheduler::create();
+		_tickTaskId = _tickScheduler->schedule([wself = weak_from_this()]() {
+			if (auto self = wself.lock()) {
+				self->onTick();
+			}
+		}, _tickMs, true);
+	}
+
+	void TransactionManager::stop()
+	{
+		if (_tickScheduler) {
+			_tickScheduler->cancel(_tickTaskId);
+			_tickScheduler = nullptr;
+			_tickTaskId = 0;
+		}
+	}
+
+	bool TransactionManager::add(std::shared_ptr<JCHandler> handler, int64_t timeoutMs)
+	{
+		if (!handler || !handler->valid()) {
+			return false;
+		}
+
+		const size_t hash = std::hash<std::string>()(handler->transaction);
+		const int64_t now = rtc::TimeMillis();
+
+		std::lock_guard<std::mutex> locker(_mutex);
+		if ((_size + 1) * 4 > (_mask + 1) * 3) {
+			++_stats.rejected;
+			WLOG("transaction table is full, {} pending, rejecting {}", _size, handler->transaction);
+			return false;
+		}
+
+		size_t index = hash & _mask;
+		while (_entries[index].used) {
+			if (_entries[index].hash == hash && _entries[index].transaction == handler->transaction) {
+				++_stats.rejected;
+				WLOG("duplicated transaction {}", handler->transaction);
+				return false;
+			}
+			index = (index + 1) & _mask;
+		}
+
+		Entry& entry = _entries[index];
+		entry.used = true;
+		entry.hash = hash;
+		entry.transaction = handler->transaction;
+		entry.callback = handler->callback;
+		entry.kind = handler->kind;
+		entry.sentMs = now;
+		entry.deadlineMs = now + timeoutMs;
+		++_size;
+
+		schedule(entry.transaction, entry.deadlineMs);
+		return true;
+	}
+
+	bool TransactionManager::complete(const std::string& transaction, const std::string& json)
+	{
+		const size_t hash = std::hash<std::string>()(transaction);
+
+		std::shared_ptr<JCCallback> callback;
+		{
+			std::lock_guard<std::mutex> locker(_mutex);
+			size_t index = find(transaction, hash);
+			if (index == _entries.size()) {
+				return false;
+			}
+			Entry& entry = _entries[index];
+			callback = std::move(entry.callback);
+			_latency[(size_t)entry.kind].add(rtc::TimeMillis() - entry.sentMs);
+			++_stats.completed;
+			erase(index);
+		}
+
+		if (callback) {
+			(*callback)(json);
+		}
+		return true;
+	}
+
+	void TransactionManager::failAll(const std::string& reason)
+	{
+		std::vector<std::pair<std::string, std::shared_ptr<JCCallback>>> failed;
+		{
+			std::lock_guard<std::mutex> locker(_mutex);
+			for (auto& entry : _entries) {
+				if (entry.used) {
+					failed.emplace_back(std::move(entry.transaction), std::move(entry.callback));
+					entry = Entry();
+				}
+			}
+			_size = 0;
+			for (auto& slot : _wheel) {
+				slot.clear();
+			}
+		}
+
+		for (const auto& item : failed) {
+			if (item.second) {
+				(*item.second)(errorResponse(item.first, kRejectedErrorCode, reason));
+			}
+		}
+	}
+
+	void TransactionManager::retain(const std::string& transaction, JsonBufferPtr payload)
+	{
+		const size_t hash = std::hash<std::string>()(transaction);
+
+		std::lock_guard<std::mutex> locker(_mutex);
+		size_t index = find(transaction, hash);
+		if (index != _entries.size()) {
+			_entries[index].payload = std::move(payload);
+		}
+	}
+
+	std::vector<TransactionManager::Pending> TransactionManager::takePending()
+	{
+		std::vector<Pending> pending;
+
+		std::lock_guard<std::mutex> locker(_mutex);
+		for (auto& entry : _entries) {
+			if (entry.used) {
+				Pending item;
+				item.handler = std::make_shared<JCHandler>(std::move(entry.transaction), std::move(entry.callback), entry.kind);
+				item.payload = std::move(entry.payload);
+				pending.emplace_back(std::move(item));
+				entry = Entry();
+			}
+		}
+		_size = 0;
+		for (auto& slot : _wheel) {
+			slot.clear();
+		}
+		return pending;
+	}
+
+	size_t TransactionManager::pending() const
+	{
+		std::lock_guard<std::mutex> locker(_mutex);
+		return _size;
+	}
+
+	LatencyHistogram::Snapshot TransactionManager::latency(TransactionKind kind) const
+	{
+		if (kind >= TransactionKind::COUNT) {
+			return LatencyHistogram::Snapshot();
+		}
+		return _latency[(size_t)kind].snapshot();
+	}
+
+	TransactionStats TransactionManager::stats() const
+	{
+		std::lock_guard<std::mutex> locker(_mutex);
+		TransactionStats stats = _stats;
+		stats.pending = _size;
+		return stats;
+	}
+
+	std::string TransactionManager::errorResponse(const std::string& transaction, int64_t code, const std::string& reason)
+	{
+		JsonBufferPtr buffer = JsonBufferPool::acquire();
+		JsonBufferWriter writer(*buffer);
+		writer.StartObject();
+		writer.Key("janus");
+		writer.String("error");
+		writer.Key("transaction");
+		writer.String(transaction.c_str(), (rapidjson::SizeType)transaction.size());
+		writer.Key("error");
+		writer.StartObject();
+		writer.Key("code");
+		writer.Int64(code);
+		writer.Key("reason");
+		writer.String(reason.c_str(), (rapidjson::SizeType)reason.size());
+		writer.EndObject();
+		writer.EndObject();
+		return std::string(buffer->GetString(), buffer->GetSize());
+	}
+
+	size_t TransactionManager::find(const std::string& transaction, size_t hash) const
+	{
+		size_t index = hash & _mask;
+		while (_entries[index].used) {
+			if (_entries[index].hash == hash && _entries[index].transaction == transaction) {
+				return index;
+			}
+			index = (index + 1) & _mask;
+		}
+		return _entries.size();
+	}
+
+	void TransactionManager::erase(size_t index)
+	{
+		size_t hole = index;
+		size_t next = index;
+		while (true) {
+			next = (next + 1) & _mask;
+			if (!_entries[next].used) {
+				break;
+			}
+			// Leave the entry in place if its home slot lies cyclically in (hole, next]
+			size_t home = _entries[next].hash & _mask;
+			bool inRange = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+			if (inRange) {
+				continue;
+			}
+			_entries[hole] = std::move(_entries[next]);
+			hole = next;
+		}
+		_entries[hole] = Entry();
+		--_size;
+	}
+
+	void TransactionManager::schedule(const std::string& transaction, int64_t deadlineMs)
+	{
+		int64_t tick = (deadlineMs + _tickMs - 1) / _tickMs;
+		if (tick <= _currentTick) {
+			tick = _currentTick + 1;
+		}
+		_wheel[tick % kWheelSlots].emplace_back(transaction);
+	}
+
+	void TransactionManager::onTick()
+	{
+		const int64_t now = rtc::TimeMillis();
+		const int64_t nowTick = now / _tickMs;
+
+		std::vector<std::pair<std::string, std::shared_ptr<JCCallback>>> expired;
+		{
+			std::lock_guard<std::mutex> locker(_mutex);
+			// Catching up more than one revolution would only revisit the same slots
+			int64_t fromTick = std::max(_currentTick + 1, nowTick - (int64_t)kWheelSlots + 1);
+			_currentTick = std::max(_currentTick, nowTick);
+			for (int64_t tick = fromTick; tick <= nowTick; ++tick) {
+				std::vector<std::string> slot;
+				slot.swap(_wheel[tick % kWheelSlots]);
+				for (auto& transaction : slot) {
+					const size_t hash = std::hash<std::string>()(transaction);
+					size_t index = find(transaction, hash);
+					if (index == _entries.size()) {
+						// completed in time
+						continue;
+					}
+					Entry& entry = _entries[index];
+					if (entry.deadlineMs > now) {
+						// deadline is more than one revolution away
+						schedule(entry.transaction, entry.deadlineMs);
+						continue;
+					}
+					WLOG("transaction {} timed out after {} ms", entry.transaction, now - entry.sentMs);
+					expired.emplace_back(std::move(entry.transaction), std::move(entry.callback));
+					++_stats.timedOut;
+					erase(index);
+				}
+			}
+		}
+
+		for (const auto& item : expired) {
+			if (item.second) {
+				(*item.second)(errorResponse(item.first, kTimeoutErrorCode, "Request timed out"));
+			}
+		}
+	}
+}
@@ -0,0 +1,119 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <array>
+#include "i_message_transport.h"
+#include "utils/latency_histogram.h"
+
+namespace vi {
+	class TaskScheduler;
+
+	// Pending Janus transactions, keyed by transaction id.
+	// The table is a fixed-size open-addressing hash table, so a gateway that never answers
+	// can not make it grow: once it is 3/4 full new transactions are rejected. Every entry
+	// carries a deadline, a timer wheel expires overdue entries and fails their callbacks
+	// with a synthesized Janus error (code kTimeoutErrorCode).
+	class TransactionManager : public std::enable_shared_from_this<TransactionManager>
+	{
+	public:
+		static const int64_t kDefaultTimeoutMs = 10000;
+
+		static const int64_t kTimeoutErrorCode = 408;
+
+		static const int64_t kRejectedErrorCode = 503;
+
+		// |capacity| is rounded up to a power of two
+		TransactionManager(size_t capacity = 1024, uint32_t tickMs = 100);
+
+		~TransactionManager();
+
+		void start();
+
+		void stop();
+
+		// Registers |handler|, returns false if the table is full or the transaction is already pending.
+		bool add(std::shared_ptr<JCHandler> handler, int64_t timeoutMs = kDefaultTimeoutMs);
+
+		// Completes |transaction| with |json|, returns false if it is unknown (or already expired).
+		bool complete(const std::string& transaction, const std::string& json);
+
+		// Fails every pending transaction with |reason|.
+		void failAll(const std::string& reason);
+
+		// Keeps the serialized request of a pending |transaction| so it can be replayed after a reconnect.
+		void retain(const std::string& transaction, JsonBufferPtr payload);
+
+		struct Pending {
+			std::shared_ptr<JCHandler> handler;
+			JsonBufferPtr payload;
+		};
+
+		// Removes every pending transaction and hands it back with its retained request (if any).
+		std::vector<Pending> takePending();
+
+		size_t pending() const;
+
+		LatencyHistogram::Snapshot latency(TransactionKind kind) const;
+
+		TransactionStats stats() const;
+
+		static std::string errorResponse(const std::string& transaction, int64_t code, const std::string& reason);
+
+	private:
+		struct Entry {
+			bool used = false;
+			size_t hash = 0;
+			std::string transaction;
+			std::shared_ptr<JCCallback> callback;
+			TransactionKind kind = TransactionKind::OTHER;
+			int64_t sentMs = 0;
+			int64_t deadlineMs = 0;
+			JsonBufferPtr payload;
+		};
+
+		// caller holds _mutex
+		size_t find(const std::string& transaction, size_t hash) const;
+
+		// caller holds _mutex, backward-shift deletion keeps probe chains intact without tombstones
+		void erase(size_t index);
+
+		// caller holds _mutex
+		void schedule(const std::string& transaction, int64_t deadlineMs);
+
+		void onTick();
+
+	private:
+		static const size_t kWheelSlots = 128;
+
+		const size_t _mask;
+
+		const uint32_t _tickMs;
+
+		mutable std::mutex _mutex;
+
+		std::vector<Entry> _entries;
+
+		size_t _size = 0;
+
+		std::array<std::vector<std::string>, kWheelSlots> _wheel;
+
+		int64_t _currentTick = 0;
+
+		std::array<LatencyHistogram, (size_t)TransactionKind::COUNT> _latency;
+
+		TransactionStats _stats;
+
+		std::shared_ptr<TaskScheduler> _tickScheduler;
+
+		uint64_t _tickTaskId = 0;
+	};
+}
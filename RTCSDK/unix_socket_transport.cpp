@@ -0,0 +1,241 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#include "unix_socket_transport.h"
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include "logger/logger.h"
+
+#if defined(WEBRTC_POSIX)
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+namespace vi {
+	namespace {
+		const char kSeqpacketScheme[] = "unix://";
+
+		const char kDgramScheme[] = "unix+dgram://";
+
+		bool startsWith(const std::string& str, const char* prefix)
+		{
+			return str.compare(0, std::strlen(prefix), prefix) == 0;
+		}
+
+		// poll timeout, bounds how long closing or destroying waits for the reader
+		const int kPollIntervalMs = 100;
+
+		// initial receive buffer, grown for larger datagrams (e.g. an SDP with many candidates)
+		const size_t kReceiveBufferSize = 64 * 1024;
+	}
+
+	UnixSocketTransport::UnixSocketTransport(rtc::Thread* thread)
+		: MessageTransport(thread, nullptr)
+	{
+	}
+
+	UnixSocketTransport::~UnixSocketTransport()
+	{
+		DLOG("~UnixSocketTransport()");
+		stopReader();
+	}
+
+	bool UnixSocketTransport::isUnixSocketUrl(const std::string& url)
+	{
+		return startsWith(url, kSeqpacketScheme) || startsWith(url, kDgramScheme);
+	}
+
+	bool UnixSocketTransport::isValid()
+	{
+		return _fd >= 0;
+	}
+
+#if defined(WEBRTC_POSIX)
+	bool UnixSocketTransport::openConnection(const std::string& url)
+	{
+		stopReader();
+
+		const bool dgram = startsWith(url, kDgramScheme);
+		const std::string path = url.substr(std::strlen(dgram ? kDgramScheme : kSeqpacketScheme));
+
+		sockaddr_un remote;
+		std::memset(&remote, 0, sizeof(remote));
+		remote.sun_family = AF_UNIX;
+		if (path.empty() || path.size() >= sizeof(remote.sun_path)) {
+			onFail(EINVAL, "invalid unix socket path: " + path);
+			return false;
+		}
+		std::memcpy(remote.sun_path, path.c_str(), path.size());
+
+		int fd = ::socket(AF_UNIX, dgram ? SOCK_DGRAM : SOCK_SEQPACKET, 0);
+		if (fd < 0) {
+			onFail(errno, std::strerror(errno));
+			return false;
+		}
+		::fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+		if (dgram) {
+			// replies to a datagram socket need an address to go to
+			static std::atomic<uint32_t> counter{ 0 };
+			_localPath = "/tmp/janus-client-" + std::to_string(::getpid()) + "-" + std::to_string(counter++) + ".sock";
+			sockaddr_un local;
+			std::memset(&local, 0, sizeof(local));
+			local.sun_family = AF_UNIX;
+			std::memcpy(local.sun_path, _localPath.c_str(), std::min(_localPath.size(), sizeof(local.sun_path) - 1));
+			::unlink(local.sun_path);
+			if (::bind(fd, (const sockaddr*)&local, sizeof(local)) < 0) {
+				int error = errno;
+				::close(fd);
+				_localPath.clear();
+				onFail(error, std::strerror(error));
+				return false;
+			}
+		}
+
+		if (::connect(fd, (const sockaddr*)&remote, sizeof(remote)) < 0) {
+			int error = errno;
+			::close(fd);
+			if (!_localPath.empty()) {
+				::unlink(_localPath.c_str());
+				_localPath.clear();
+			}
+			onFail(error, std::strerror(error));
+			return false;
+		}
+
+		_fd = fd;
+		_stopped = false;
+		_closeRequested = false;
+		_reader = std::thread(&UnixSocketTransport::readLoop, this, fd);
+		return true;
+	}
+
+	void UnixSocketTransport::closeConnection()
+	{
+		_closeRequested = true;
+	}
+
+	bool UnixSocketTransport::writeText(const char* data, size_t size)
+	{
+		int fd = _fd;
+		if (fd < 0) {
+			return false;
+		}
+		if (::send(fd, data, size, MSG_NOSIGNAL) < 0) {
+			ELOG("send to unix socket failed: {}", std::strerror(errno));
+			return false;
+		}
+		return true;
+	}
+
+	size_t UnixSocketTransport::bufferedAmount()
+	{
+#if defined(TIOCOUTQ)
+		int fd = _fd;
+		int pending = 0;
+		if (fd >= 0 && ::ioctl(fd, TIOCOUTQ, &pending) == 0 && pending > 0) {
+			return (size_t)pending;
+		}
+#endif
+		return 0;
+	}
+
+	void UnixSocketTransport::readLoop(int fd)
+	{
+		onOpen();
+
+		std::vector<char> buffer(kReceiveBufferSize);
+		while (!_stopped) {
+			if (_closeRequested) {
+				onClose(1000, "");
+				break;
+			}
+
+			pollfd pfd;
+			pfd.fd = fd;
+			pfd.events = POLLIN;
+			pfd.revents = 0;
+			int ret = ::poll(&pfd, 1, kPollIntervalMs);
+			if (ret == 0 || (ret < 0 && errno == EINTR)) {
+				continue;
+			}
+			if (ret < 0 || (pfd.revents & (POLLERR | POLLNVAL))) {
+				onFail(errno, ret < 0 ? std::strerror(errno) : "unix socket error");
+				break;
+			}
+
+			// peek at the datagram size first so that nothing gets truncated
+			ssize_t size = ::recv(fd, nullptr, 0, MSG_PEEK | MSG_TRUNC);
+			if (size > (ssize_t)buffer.size()) {
+				buffer.resize((size_t)size);
+			}
+			ssize_t n = ::recv(fd, buffer.data(), buffer.size(), 0);
+			if (n < 0) {
+				if (errno == EINTR || errno == EAGAIN) {
+					continue;
+				}
+				onFail(errno, std::strerror(errno));
+				break;
+			}
+			if (n == 0) {
+				onClose(1001, "closed by the gateway");
+				break;
+			}
+			onTextMessage(std::string(buffer.data(), (size_t)n));
+		}
+
+		_fd = -1;
+		::close(fd);
+		if (!_localPath.empty()) {
+			::unlink(_localPath.c_str());
+		}
+	}
+#else
+	bool UnixSocketTransport::openConnection(const std::string& url)
+	{
+		onFail(-1, "unix sockets are not supported on this platform");
+		return false;
+	}
+
+	void UnixSocketTransport::closeConnection()
+	{
+	}
+
+	bool UnixSocketTransport::writeText(const char* data, size_t size)
+	{
+		return false;
+	}
+
+	size_t UnixSocketTransport::bufferedAmount()
+	{
+		return 0;
+	}
+
+	void UnixSocketTransport::readLoop(int fd)
+	{
+	}
+#endif
+
+	void UnixSocketTransport::stopReader()
+	{
+		_stopped = true;
+		if (_reader.joinable()) {
+			if (_reader.get_id() == std::this_thread::get_id()) {
+				_reader.detach();
+			}
+			else {
+				_reader.join();
+			}
+		}
+		_localPath.clear();
+	}
+}
@@ -0,0 +1,59 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include "message_transport.h"
+
+namespace vi {
+	// Talks to Janus's UnixSockets transport, for clients running on the gateway host.
+	// Every Janus message is one datagram, so there is no TLS, masking or framing:
+	//   unix:///path/to/janus.sock        SOCK_SEQPACKET (the default of the Janus transport)
+	//   unix+dgram:///path/to/janus.sock  SOCK_DGRAM, a local socket is bound to receive replies
+	// Transactions, callbacks, queueing and listener events are those of MessageTransport.
+	class UnixSocketTransport : public MessageTransport
+	{
+	public:
+		explicit UnixSocketTransport(rtc::Thread* thread);
+
+		~UnixSocketTransport() override;
+
+		static bool isUnixSocketUrl(const std::string& url);
+
+	protected:
+		bool openConnection(const std::string& url) override;
+
+		void closeConnection() override;
+
+		bool writeText(const char* data, size_t size) override;
+
+		size_t bufferedAmount() override;
+
+		bool isValid() override;
+
+	private:
+		void readLoop(int fd);
+
+		void stopReader();
+
+	private:
+		std::atomic<int> _fd{ -1 };
+
+		std::string _localPath;
+
+		std::thread _reader;
+
+		// set by the destructor and before reconnecting, the reader exits without reporting
+		std::atomic_bool _stopped = false;
+
+		// set by disconnect(), the reader exits and reports onClose
+		std::atomic_bool _closeRequested = false;
+	};
+}
@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <string>
+#include <typeindex>
 #include "absl/types/optional.h"
 
 namespace vi {
@@ -24,6 +25,9 @@ namespace vi {
         
         virtual bool shouldAccept(const std::shared_ptr<INotification>& nf) = 0;
         
+        // The notification type subscribed to, NotificationCenter indexes observers by it
+        virtual std::type_index notificationType() const = 0;
+        
         virtual bool equals(const IObserver& observer) const = 0;
         
         virtual bool isValid() = 0;
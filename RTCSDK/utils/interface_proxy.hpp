@@ -248,4 +248,46 @@ private:
     return call.marshal(_threadName);                                              \
 }
 
+// Fire-and-forget variants: the call is posted to the proxy thread (or run in place on it) and the
+// caller does not wait. The posted call keeps the object alive and calls keep their order.
+
+#define PROXY_ASYNC_POST(call)                                                      \
+    rtc::Thread* thread = TMgr->thread(_threadName);                               \
+    assert(thread);                                                                 \
+    if (thread->IsCurrent()) {                                                      \
+    call(_c);                                                                       \
+    return;                                                                         \
+    }                                                                               \
+    thread->PostTask(RTC_FROM_HERE, [c = _c, call]() { call(c); });
+
+#define PROXY_ASYNC_METHOD0(method)                                                 \
+    void method() override {                                                        \
+    auto call = [](const std::shared_ptr<INTERNAL_CLASS>& c) { c->method(); };      \
+    PROXY_ASYNC_POST(call)                                                          \
+}
+
+#define PROXY_ASYNC_METHOD1(method, t1)                                             \
+    void method(t1 a1) override {                                                   \
+    auto call = [a1 = std::decay_t<t1>(std::move(a1))](                             \
+    const std::shared_ptr<INTERNAL_CLASS>& c) { c->method(a1); };                   \
+    PROXY_ASYNC_POST(call)                                                          \
+}
+
+#define PROXY_ASYNC_METHOD2(method, t1, t2)                                         \
+    void method(t1 a1, t2 a2) override {                                            \
+    auto call = [a1 = std::decay_t<t1>(std::move(a1)),                              \
+    a2 = std::decay_t<t2>(std::move(a2))](                                          \
+    const std::shared_ptr<INTERNAL_CLASS>& c) { c->method(a1, a2); };               \
+    PROXY_ASYNC_POST(call)                                                          \
+}
+
+#define PROXY_ASYNC_METHOD3(method, t1, t2, t3)                                     \
+    void method(t1 a1, t2 a2, t3 a3) override {                                     \
+    auto call = [a1 = std::decay_t<t1>(std::move(a1)),                              \
+    a2 = std::decay_t<t2>(std::move(a2)),                                           \
+    a3 = std::decay_t<t3>(std::move(a3))](                                          \
+    const std::shared_ptr<INTERNAL_CLASS>& c) { c->method(a1, a2, a3); };           \
+    PROXY_ASYNC_POST(call)                                                          \
+}
+
 }
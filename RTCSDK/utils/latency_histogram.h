@@ -0,0 +1,113 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace vi {
+	// Lock-free latency histogram with fixed millisecond buckets, safe to update from any thread.
+	class LatencyHistogram
+	{
+	public:
+		static constexpr size_t kBucketCount = 14;
+
+		// Upper bound (inclusive, in ms) of each bucket, the last bucket is open ended.
+		static const std::array<int64_t, kBucketCount>& bounds()
+		{
+			static const std::array<int64_t, kBucketCount> kBounds = {
+				1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, std::numeric_limits<int64_t>::max()
+			};
+			return kBounds;
+		}
+
+		struct Snapshot {
+			std::array<uint64_t, kBucketCount> counts{};
+			uint64_t count = 0;
+			int64_t sumMs = 0;
+			int64_t maxMs = 0;
+
+			int64_t averageMs() const
+			{
+				return count == 0 ? 0 : sumMs / (int64_t)count;
+			}
+
+			// Upper bound of the bucket holding the |p| (0.0 - 1.0) percentile.
+			int64_t percentileMs(double p) const
+			{
+				if (count == 0) {
+					return 0;
+				}
+				uint64_t rank = (uint64_t)(p * count);
+				uint64_t seen = 0;
+				for (size_t i = 0; i < kBucketCount; ++i) {
+					seen += counts[i];
+					if (seen > rank) {
+						return i + 1 == kBucketCount ? maxMs : bounds()[i];
+					}
+				}
+				return maxMs;
+			}
+		};
+
+		LatencyHistogram()
+		{
+			reset();
+		}
+
+		void add(int64_t ms)
+		{
+			if (ms < 0) {
+				ms = 0;
+			}
+			size_t index = 0;
+			while (index + 1 < kBucketCount && ms > bounds()[index]) {
+				++index;
+			}
+			_counts[index].fetch_add(1, std::memory_order_relaxed);
+			_count.fetch_add(1, std::memory_order_relaxed);
+			_sumMs.fetch_add(ms, std::memory_order_relaxed);
+
+			int64_t max = _maxMs.load(std::memory_order_relaxed);
+			while (ms > max && !_maxMs.compare_exchange_weak(max, ms, std::memory_order_relaxed)) {
+			}
+		}
+
+		Snapshot snapshot() const
+		{
+			Snapshot snapshot;
+			for (size_t i = 0; i < kBucketCount; ++i) {
+				snapshot.counts[i] = _counts[i].load(std::memory_order_relaxed);
+			}
+			snapshot.count = _count.load(std::memory_order_relaxed);
+			snapshot.sumMs = _sumMs.load(std::memory_order_relaxed);
+			snapshot.maxMs = _maxMs.load(std::memory_order_relaxed);
+			return snapshot;
+		}
+
+		void reset()
+		{
+			for (auto& count : _counts) {
+				count.store(0, std::memory_order_relaxed);
+			}
+			_count.store(0, std::memory_order_relaxed);
+			_sumMs.store(0, std::memory_order_relaxed);
+			_maxMs.store(0, std::memory_order_relaxed);
+		}
+
+	private:
+		std::array<std::atomic<uint64_t>, kBucketCount> _counts;
+
+		std::atomic<uint64_t> _count;
+
+		std::atomic<int64_t> _sumMs;
+
+		std::atomic<int64_t> _maxMs;
+	};
+}
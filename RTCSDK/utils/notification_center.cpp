@@ -18,18 +18,52 @@ namespace vi {
 
     void NotificationCenter::addObserver(const IObserver& observer)
     {
-        rtc::CritScope scope(&_criticalSection);
-        if (!hasObserverInternal(observer)) {
-            _observers.emplace_back(observer.clone());
+        std::shared_ptr<IObserver> copy(observer.clone());
+        auto provider = TMgr;
+        rtc::Thread* thread = provider->thread(provider->handle(copy->scheduleThread().value_or("")));
+        if (!thread) {
+            // unknown thread, rejected here rather than failing on every post
+            return;
         }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (hasObserverInternal(observer)) {
+            return;
+        }
+        const std::type_index type = observer.notificationType();
+        auto it = _topics.find(type);
+        auto entries = std::make_shared<std::vector<Entry>>();
+        if (it != _topics.end()) {
+            *entries = *it->second;
+        }
+        else {
+            _routes.clear();
+        }
+        entries->emplace_back(Entry{ std::move(copy), thread });
+        _topics[type] = std::move(entries);
+        ++_count;
     }
 
     void NotificationCenter::removeObserver(const IObserver& observer)
     {
-        rtc::CritScope scope(&_criticalSection);
-        for (auto it = _observers.begin(); it != _observers.end(); ++it) {
-            if (observer.equals(**it)) {
-                _observers.erase(it);
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _topics.find(observer.notificationType());
+        if (it == _topics.end()) {
+            return;
+        }
+        const auto& entries = *it->second;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (observer.equals(*entries[i].observer)) {
+                if (entries.size() == 1) {
+                    _topics.erase(it);
+                    _routes.clear();
+                }
+                else {
+                    auto copy = std::make_shared<std::vector<Entry>>(entries);
+                    copy->erase(copy->begin() + i);
+                    it->second = std::move(copy);
+                }
+                --_count;
                 return;
             }
         }
@@ -37,7 +71,7 @@ namespace vi {
 
     bool NotificationCenter::hasObserver(const IObserver& observer)
     {
-        rtc::CritScope scope(&_criticalSection);
+        std::lock_guard<std::mutex> lock(_mutex);
         return hasObserverInternal(observer);
     }
 
@@ -48,58 +82,113 @@ namespace vi {
 
     void NotificationCenter::clearObserver()
     {
-        rtc::CritScope scope(&_criticalSection);
-        _observers.clear();
+        std::lock_guard<std::mutex> lock(_mutex);
+        _topics.clear();
+        _routes.clear();
+        _count = 0;
     }
 
     std::size_t NotificationCenter::numOfObservers()
     {
-        rtc::CritScope scope(&_criticalSection);
-        return _observers.size();
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _count;
     }
 
     bool NotificationCenter::hasObserverInternal(const IObserver& observer)
     {
-        for (auto it = _observers.begin(); it != _observers.end(); ++it) {
-            if (observer.equals(**it)) {
+        auto it = _topics.find(observer.notificationType());
+        if (it == _topics.end()) {
+            return false;
+        }
+        for (const auto& entry : *it->second) {
+            if (observer.equals(*entry.observer)) {
                 return true;
             }
         }
         return false;
     }
 
-    void NotificationCenter::removeInvalidObservers()
+    const std::vector<std::type_index>& NotificationCenter::routesOf(const std::type_index& type, const std::shared_ptr<INotification>& notification)
+    {
+        auto it = _routes.find(type);
+        if (it != _routes.end()) {
+            return it->second;
+        }
+        // every observer of a topic subscribes to the same type, asking the first one is enough
+        std::vector<std::type_index> routes;
+        for (const auto& topic : _topics) {
+            if (topic.second->front().observer->shouldAccept(notification)) {
+                routes.emplace_back(topic.first);
+            }
+        }
+        return _routes.emplace(type, std::move(routes)).first->second;
+    }
+
+    void NotificationCenter::removeInvalidObservers(const std::vector<std::type_index>& topics)
     {
-        _observers.erase(std::remove_if(_observers.begin(), _observers.end(), [](const auto& observer) {
-            return !observer->isValid();
-            }), _observers.end());
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto& type : topics) {
+            auto it = _topics.find(type);
+            if (it == _topics.end()) {
+                continue;
+            }
+            auto entries = std::make_shared<std::vector<Entry>>();
+            for (const auto& entry : *it->second) {
+                if (entry.observer->isValid()) {
+                    entries->emplace_back(entry);
+                }
+            }
+            _count -= it->second->size() - entries->size();
+            if (entries->empty()) {
+                _topics.erase(it);
+                _routes.clear();
+            }
+            else {
+                it->second = std::move(entries);
+            }
+        }
     }
 
     void NotificationCenter::notifyObservers(const std::shared_ptr<INotification>& notification)
     {
-        decltype(_observers) observers;
+        if (!notification) {
+            return;
+        }
+
+        std::vector<std::pair<std::type_index, Topic>> topics;
         {
-            rtc::CritScope scope(&_criticalSection);
-            removeInvalidObservers();
-            observers = _observers;
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (const auto& type : routesOf(typeid(*notification), notification)) {
+                topics.emplace_back(type, _topics[type]);
+            }
         }
 
-        for (const auto& observer : observers) {
-            if (observer && observer->shouldAccept(notification)) {
-                absl::optional<std::string> scheduleThread = observer->scheduleThread();
-                rtc::Thread* thread = TMgr->thread(scheduleThread.value_or(""));
-                assert(thread);
-                if (thread->IsCurrent()) {
-				    observer->notify(notification);
+        std::vector<std::type_index> invalid;
+        for (const auto& topic : topics) {
+            bool pruned = false;
+            for (const auto& entry : *topic.second) {
+                if (!entry.observer->isValid()) {
+                    pruned = true;
+                    continue;
+                }
+                if (entry.thread->IsCurrent()) {
+                    entry.observer->notify(notification);
                 }
                 else {
-					thread->PostTask(RTC_FROM_HERE, [obs = std::weak_ptr<IObserver>(observer), notification]() {
-						if (auto observer = obs.lock()) {
-							observer->notify(notification);
-						}
-					});
+                    entry.thread->PostTask(RTC_FROM_HERE, [obs = std::weak_ptr<IObserver>(entry.observer), notification]() {
+                        if (auto observer = obs.lock()) {
+                            observer->notify(notification);
+                        }
+                    });
                 }
             }
+            if (pruned) {
+                invalid.emplace_back(topic.first);
+            }
+        }
+
+        if (!invalid.empty()) {
+            removeInvalidObservers(invalid);
         }
     }
 
@@ -2,8 +2,14 @@
 #pragma once
 
 #include <memory>
-#include <list>
-#include "rtc_base/deprecated/recursive_critical_section.h"
+#include <vector>
+#include <mutex>
+#include <typeindex>
+#include <unordered_map>
+
+namespace rtc {
+    class Thread;
+}
 
 namespace vi {
 
@@ -95,16 +101,35 @@ namespace vi {
         static const std::shared_ptr<NotificationCenter>& defaultCenter();
                 
     private:
+        struct Entry {
+            std::shared_ptr<IObserver> observer;
+            // resolved once from observer->scheduleThread()
+            rtc::Thread* thread;
+        };
+
+        // Copy-on-write, a post holds on to the vector it started with
+        using Topic = std::shared_ptr<const std::vector<Entry>>;
+
         void notifyObservers(const std::shared_ptr<INotification>& notification);
         
         bool hasObserverInternal(const IObserver& observer);
         
-        void removeInvalidObservers();
+        // Topics interested in notifications of |type|, computed on the first post and cached.
+        const std::vector<std::type_index>& routesOf(const std::type_index& type, const std::shared_ptr<INotification>& notification);
+
+        // Drops the observers whose target is gone, found while posting.
+        void removeInvalidObservers(const std::vector<std::type_index>& topics);
             
     private:
-        rtc::RecursiveCriticalSection _criticalSection;
+        std::mutex _mutex;
             
-        std::list<std::shared_ptr<IObserver>> _observers;
+        // keyed by the notification type an observer subscribes to, never holds an empty topic
+        std::unordered_map<std::type_index, Topic> _topics;
+
+        // keyed by the dynamic type of a posted notification, cleared when the set of topics changes
+        std::unordered_map<std::type_index, std::vector<std::type_index>> _routes;
+
+        std::size_t _count = 0;
     };
     
 }
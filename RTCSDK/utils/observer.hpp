@@ -17,7 +17,7 @@ namespace vi {
         Observer(const std::shared_ptr<T>& object, Method method)
         : _object(object)
         , _method(method)
-        , m_queue(std::string("main"))
+        , _scheduleThread(std::string("main"))
         {
         }
         
@@ -74,6 +74,11 @@ namespace vi {
             return std::dynamic_pointer_cast<N>(nf) != nullptr;
         }
         
+        std::type_index notificationType() const override
+        {
+            return typeid(N);
+        }
+        
         bool equals(const IObserver& observer) const override
         {
             auto obs = dynamic_cast<const Observer*>(&observer);
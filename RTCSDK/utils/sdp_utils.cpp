@@ -5,215 +5,337 @@
  **/
 
 #include "sdp_utils.h"
-#include <regex>
+#include <algorithm>
+#include <cctype>
 #include <random>
 #include <sstream>
 #include <iomanip>
 
 namespace vi
 {
-	bool parseMline(const std::string &line, std::string &type)
-	{
-		static std::regex re("^m=(\\S+) ", std::regex_constants::ECMAScript | std::regex_constants::icase);
-		std::smatch match;
-		if (std::regex_search(line, match, re)) {
-			type = match[1].str();
+	namespace {
+		bool equalsIgnoreCase(absl::string_view a, absl::string_view b)
+		{
+			if (a.size() != b.size()) {
+				return false;
+			}
+			for (size_t i = 0; i < a.size(); ++i) {
+				if (::tolower(static_cast<unsigned char>(a[i])) != ::tolower(static_cast<unsigned char>(b[i]))) {
+					return false;
+				}
+			}
 			return true;
 		}
-		else {
-			return false;
+
+		bool startsWithIgnoreCase(absl::string_view text, absl::string_view prefix)
+		{
+			return text.size() >= prefix.size() && equalsIgnoreCase(text.substr(0, prefix.size()), prefix);
 		}
-	}
 
-	bool parseFid(const std::string &line, std::string &ssrc, std::string &ssrcFid)
-	{
-		static std::regex re("a=ssrc-group:FID (\\d+) (\\d+)\\r", std::regex_constants::ECMAScript | std::regex_constants::icase);
-		std::smatch match;
-		if (std::regex_match(line, match, re)) {
-			ssrc = match[1].str();
-			ssrcFid = match[2].str();
+		// Splits |text| at the first |delim|, |rest| is empty if there is none.
+		absl::string_view token(absl::string_view text, char delim, absl::string_view& rest)
+		{
+			const size_t pos = text.find(delim);
+			if (pos == absl::string_view::npos) {
+				rest = absl::string_view();
+				return text;
+			}
+			rest = text.substr(pos + 1);
+			return text.substr(0, pos);
+		}
+
+		bool isNumber(absl::string_view text)
+		{
+			if (text.empty()) {
+				return false;
+			}
+			for (char c : text) {
+				if (c < '0' || c > '9') {
+					return false;
+				}
+			}
 			return true;
 		}
-		else {
-			return false;
+
+		std::string genSsrc()
+		{
+			static std::random_device rd;
+			static std::mt19937 gen(rd());
+			static std::uniform_int_distribution<unsigned long> dis(1, 0xFFFFFFFF);
+
+			const auto value = dis(gen);
+			std::stringstream result;
+			result << std::setw(9) << std::setfill('0');
+			result << value;
+			return result.str();
 		}
-	}
 
-	bool parseCname(const std::string &line, std::string &ssrc, std::string &cname)
-	{
-		static std::regex re("a=ssrc:(\\d+) cname:(\\S+)\\r", std::regex_constants::ECMAScript | std::regex_constants::icase);
-		std::smatch match;
-		if (std::regex_match(line, match, re)) {
-			ssrc = match[1].str();
-			cname = match[2].str();
-			return true;
+		void appendSsrc(std::string& out, const std::string& ssrc, absl::string_view cname, absl::string_view mslabel, absl::string_view label, absl::string_view eol)
+		{
+			const auto append = [&out, &ssrc, eol](absl::string_view attribute, absl::string_view value, absl::string_view extra) {
+				out.append("a=ssrc:").append(ssrc).append(" ");
+				out.append(attribute.data(), attribute.size()).append(":");
+				out.append(value.data(), value.size());
+				if (!extra.empty()) {
+					out.append(" ").append(extra.data(), extra.size());
+				}
+				out.append(eol.data(), eol.size());
+			};
+			append("cname", cname, absl::string_view());
+			append("msid", mslabel, label);
+			append("mslabel", mslabel, absl::string_view());
+			append("label", label, absl::string_view());
 		}
-		else {
-			return false;
+
+		std::string appendSsrcAndFid(std::string& out, absl::string_view cname, absl::string_view mslabel, absl::string_view label, bool fid, absl::string_view eol)
+		{
+			const auto ssrc = genSsrc();
+			const auto ssrcFid = genSsrc();
+			if (fid) {
+				out.append("a=ssrc-group:FID ").append(ssrc).append(" ").append(ssrcFid).append(eol.data(), eol.size());
+			}
+			appendSsrc(out, ssrc, cname, mslabel, label, eol);
+			if (fid) {
+				appendSsrc(out, ssrcFid, cname, mslabel, label, eol);
+			}
+			return ssrc;
 		}
 	}
 
-	bool parseMslabel(const std::string &line, std::string &ssrc, std::string &mslabel)
+	SdpScanner::SdpScanner(absl::string_view sdp, size_t begin, size_t end)
+		: _sdp(sdp)
+		, _pos(begin)
+		, _end(end < sdp.size() ? end : sdp.size())
 	{
-		static std::regex re("a=ssrc:(\\d+) mslabel:(\\S+)\\r", std::regex_constants::ECMAScript | std::regex_constants::icase);
-		std::smatch match;
-		if (std::regex_match(line, match, re)) {
-			ssrc = match[1].str();
-			mslabel = match[2].str();
-			return true;
-		}
-		else {
-			return false;
-		}
 	}
 
-	bool parseLabel(const std::string &line, std::string &ssrc, std::string &label)
+	bool SdpScanner::next(SdpLine& line)
 	{
-		static std::regex re("a=ssrc:(\\d+) label:(\\S+)\\r", std::regex_constants::ECMAScript | std::regex_constants::icase);
-		std::smatch match;
-		if (std::regex_match(line, match, re)) {
-			ssrc = match[1].str();
-			label = match[2].str();
-			return true;
-		}
-		else {
+		if (_pos >= _end) {
 			return false;
 		}
+		const size_t eol = _sdp.find('\n', _pos);
+		size_t stop = eol == absl::string_view::npos || eol >= _end ? _end : eol;
+		const size_t next = stop == _end ? _end : stop + 1;
+		if (stop > _pos && _sdp[stop - 1] == '\r') {
+			--stop;
+		}
+		line.text = _sdp.substr(_pos, stop - _pos);
+		line.begin = _pos;
+		line.next = next;
+		_pos = next;
+		return true;
 	}
 
-	std::string genSsrc()
+	bool SDPUtils::parseMediaLine(absl::string_view line, absl::string_view& media, absl::string_view& formats)
 	{
-		static std::random_device rd;
-		static std::mt19937 gen(rd());
-		static std::uniform_int_distribution<unsigned long> dis(1, 0xFFFFFFFF);
-
-		const auto value = dis(gen);
-		std::stringstream result;
-		result << std::setw(9) << std::setfill('0');
-		result << value;
-		return result.str();
+		if (!startsWithIgnoreCase(line, "m=")) {
+			return false;
+		}
+		absl::string_view rest;
+		media = token(line.substr(2), ' ', rest);
+		if (media.empty() || rest.empty()) {
+			return false;
+		}
+		// port, then protocol
+		token(rest, ' ', rest);
+		token(rest, ' ', formats);
+		return true;
 	}
 
-	void injectSsrc(std::vector<std::string> &lines, const std::string &ssrc, const std::string &cname, const std::string &mslabel, const std::string &label)
+	bool SDPUtils::parseSsrcAttribute(absl::string_view line, absl::string_view& ssrc, absl::string_view& attribute, absl::string_view& value)
 	{
-		const std::string assrc = "a=ssrc:" + ssrc;
-		lines.emplace_back(assrc + " cname:" + cname + "\r");
-		lines.emplace_back(assrc + " msid:" + mslabel + " " + label + "\r");
-		lines.emplace_back(assrc + " mslabel:" + mslabel + "\r");
-		lines.emplace_back(assrc + " label:" + label + "\r");
+		if (!startsWithIgnoreCase(line, "a=ssrc:")) {
+			return false;
+		}
+		absl::string_view rest;
+		ssrc = token(line.substr(7), ' ', rest);
+		if (!isNumber(ssrc) || rest.empty()) {
+			return false;
+		}
+		attribute = token(rest, ':', value);
+		return !attribute.empty();
 	}
 
-	std::string injectSsrcAndFid(std::vector<std::string> &lines, const std::string &cname, const std::string &mslabel, const std::string &label, bool fid)
+	bool SDPUtils::parseSsrcGroup(absl::string_view line, absl::string_view& semantics, absl::string_view& ssrcs)
 	{
-		const auto ssrc = genSsrc();
-		const auto ssrcFid = genSsrc();
-		if (fid) {
-			lines.push_back("a=ssrc-group:FID " + ssrc + " " + ssrcFid + "\r");
-		}
-		injectSsrc(lines, ssrc, cname, mslabel, label);
-		if (fid) {
-			injectSsrc(lines, ssrcFid, cname, mslabel, label);
+		if (!startsWithIgnoreCase(line, "a=ssrc-group:")) {
+			return false;
 		}
-		return ssrc;
+		semantics = token(line.substr(13), ' ', ssrcs);
+		return !semantics.empty() && !ssrcs.empty();
 	}
 
-	std::vector<std::string> SDPUtils::split(const std::string& str, char delim) {
-		std::stringstream sstr(str);
-		std::string item;
-		std::vector<std::string> elems;
-		while (std::getline(sstr, item, delim)) {
-			elems.push_back(std::move(item));
+	bool SDPUtils::parseAttribute(absl::string_view line, absl::string_view& name, absl::string_view& value)
+	{
+		if (!startsWithIgnoreCase(line, "a=")) {
+			return false;
 		}
-		return elems;
+		name = token(line.substr(2), ':', value);
+		return !name.empty();
 	}
 
-	std::string SDPUtils::join(const std::vector<std::string>& lines, const std::string& separator)
+	std::vector<SdpMediaSection> SDPUtils::mediaSections(absl::string_view sdp)
 	{
-		std::string result;
-		size_t size = 0;
-		for (const auto &l : lines) size += l.size();
-		result.reserve(lines.size() * separator.size() + size + 1);
-
-		for (size_t i = 0; i < lines.size(); ++i) {
-			if (i) {
-				result += separator;
+		std::vector<SdpMediaSection> sections;
+		SdpScanner scanner(sdp);
+		SdpLine line;
+		while (scanner.next(line)) {
+			absl::string_view media, formats;
+			if (!parseMediaLine(line.text, media, formats)) {
+				continue;
+			}
+			if (!sections.empty()) {
+				sections.back().end = line.begin;
 			}
-			result += lines[i];
+			SdpMediaSection section;
+			section.media = media;
+			section.begin = line.begin;
+			section.end = sdp.size();
+			sections.emplace_back(section);
 		}
-		return result;
+		return sections;
 	}
 
-	void SDPUtils::injectSimulcast(int64_t simulcast, std::vector<std::string> &lines)
+	bool SDPUtils::injectSimulcast(int64_t simulcast, std::string& sdp)
 	{
 		if (simulcast < 1 || simulcast > 2) {
-			return;
+			return false;
 		}
 
-		std::string ssrc, ssrcFid, cname, mslabel, label;
-		size_t index2inject = 0;
-		bool video = false;
-		bool hasSimulcast = false;
+		const absl::string_view view(sdp);
+		const auto sections = mediaSections(view);
+		auto video = sections.cbegin();
+		while (video != sections.cend() && video->media != "video") {
+			++video;
+		}
+		if (video == sections.cend()) {
+			return false;
+		}
 
-		for (size_t i = 0; i < lines.size(); ++i) {
-			const auto &line = lines[i];
-			std::string mtype;
-			if (parseMline(line, mtype)) {
-				if (!video && mtype == "video") {
-					video = true;
-					continue;
+		absl::string_view ssrc, ssrcFid, cname, mslabel, label;
+		absl::string_view eol = "\n";
+		SdpScanner scanner(view, video->begin, video->end);
+		SdpLine line;
+		while (scanner.next(line)) {
+			if (line.begin == video->begin) {
+				if (line.next > line.begin + line.text.size() + 1) {
+					eol = "\r\n";
 				}
-				if (video) {
-					video = false;
-					index2inject = i - 1;
-					continue;
+				continue;
+			}
+
+			absl::string_view semantics, ssrcs;
+			if (parseSsrcGroup(line.text, semantics, ssrcs)) {
+				if (equalsIgnoreCase(semantics, "SIM")) {
+					return false;
 				}
+				if (ssrc.empty() && equalsIgnoreCase(semantics, "FID")) {
+					ssrc = token(ssrcs, ' ', ssrcFid);
+				}
+				continue;
+			}
+
+			absl::string_view lineSsrc, attribute, value;
+			if (!parseSsrcAttribute(line.text, lineSsrc, attribute, value) || value.empty()) {
+				continue;
+			}
+			if (ssrc.empty() && equalsIgnoreCase(attribute, "cname")) {
+				ssrc = lineSsrc;
 			}
-			if (!video) {
+			if (lineSsrc != ssrc) {
 				continue;
 			}
+			if (cname.empty() && equalsIgnoreCase(attribute, "cname")) {
+				cname = value;
+			}
+			else if (mslabel.empty() && equalsIgnoreCase(attribute, "mslabel")) {
+				mslabel = value;
+			}
+			else if (label.empty() && equalsIgnoreCase(attribute, "label")) {
+				label = value;
+			}
+		}
 
-			if (ssrc.empty()) {
-				if (parseFid(line, ssrc, ssrcFid)) {
-					continue;
-				}
-				parseCname(line, ssrc, cname);
+		if (ssrc.empty() || cname.empty() || mslabel.empty() || label.empty()) {
+			return false;
+		}
+
+		// the views above point into |sdp|, everything is built before it is touched
+		std::string injected;
+		if (video->end == view.size() && !view.empty() && view.back() != '\n') {
+			injected.append(eol.data(), eol.size());
+		}
+		std::string group("a=ssrc-group:SIM ");
+		group.append(ssrc.data(), ssrc.size());
+		for (int64_t i = 0; i < simulcast; ++i) {
+			group.append(" ").append(appendSsrcAndFid(injected, cname, mslabel, label, !ssrcFid.empty(), eol));
+		}
+		injected.append(group).append(eol.data(), eol.size());
+
+		sdp.insert(video->end, injected);
+		return true;
+	}
+
+	bool SDPUtils::preferCodec(std::string& sdp, absl::string_view media, absl::string_view codec)
+	{
+		bool reordered = false;
+		const auto sections = mediaSections(sdp);
+		// the m-line keeps its length, the offsets of the other sections stay valid
+		for (const auto& section : sections) {
+			if (section.media != media) {
+				continue;
 			}
 
-			if (ssrc.length()) {
-				std::string tmpSsrc, value;
-				if (cname.empty() && parseCname(line, tmpSsrc, value) && tmpSsrc == ssrc) {
-					cname = value;
+			std::vector<absl::string_view> preferred;
+			SdpScanner scanner(sdp, section.begin, section.end);
+			SdpLine mline;
+			scanner.next(mline);
+			SdpLine line;
+			while (scanner.next(line)) {
+				absl::string_view name, value;
+				if (!parseAttribute(line.text, name, value) || name != "rtpmap") {
 					continue;
 				}
-
-				if (mslabel.empty() && parseMslabel(line, tmpSsrc, value) && tmpSsrc == ssrc) {
-					mslabel = value;
-					continue;
+				absl::string_view encoding;
+				const auto payloadType = token(value, ' ', encoding);
+				absl::string_view clockRate;
+				if (equalsIgnoreCase(token(encoding, '/', clockRate), codec)) {
+					preferred.emplace_back(payloadType);
 				}
+			}
+
+			absl::string_view mediaType, formats;
+			if (preferred.empty() || !parseMediaLine(mline.text, mediaType, formats)) {
+				continue;
+			}
 
-				if (label.empty() && parseLabel(line, tmpSsrc, value) && tmpSsrc == ssrc) {
-					label = value;
+			std::string reorderedFormats;
+			reorderedFormats.reserve(formats.size());
+			for (const auto& payloadType : preferred) {
+				if (!reorderedFormats.empty()) {
+					reorderedFormats.append(" ");
+				}
+				reorderedFormats.append(payloadType.data(), payloadType.size());
+			}
+			absl::string_view rest = formats;
+			while (!rest.empty()) {
+				const auto format = token(rest, ' ', rest);
+				if (format.empty() || std::find(preferred.begin(), preferred.end(), format) != preferred.end()) {
 					continue;
 				}
+				reorderedFormats.append(" ").append(format.data(), format.size());
 			}
-
-			if (line.find("a=ssrc-group:SIM ") == 0) {
-				hasSimulcast = true;
+			if (reorderedFormats.size() != formats.size()) {
+				continue;
 			}
-		}
 
-		if (!hasSimulcast && ssrc.length() && cname.length() && mslabel.length() && label.length()) {
-			std::stringstream group;
-			std::vector<std::string> simulcastLines;
-			group << "a=ssrc-group:SIM " + ssrc;
-			for (int64_t i = 0; i < simulcast; ++i) {
-				const auto assrc = injectSsrcAndFid(simulcastLines, cname, mslabel, label, ssrcFid.length());
-				group << " " << assrc;
+			const size_t offset = formats.data() - sdp.data();
+			if (sdp.compare(offset, formats.size(), reorderedFormats) != 0) {
+				sdp.replace(offset, formats.size(), reorderedFormats);
+				reordered = true;
 			}
-			group << "\r";
-			simulcastLines.emplace_back(group.str());
-			const auto insertIt = index2inject ? lines.begin() + index2inject : lines.end();
-			lines.insert(insertIt, simulcastLines.begin(), simulcastLines.end());
 		}
+		return reordered;
 	}
-}
\ No newline at end of file
+}
@@ -8,16 +8,76 @@
 
 #include <string>
 #include <vector>
+#include "absl/strings/string_view.h"
 
 namespace vi
 {
-	class SDPUtils 
+	// One line of an SDP without its line break, viewing into the SDP it was scanned from.
+	struct SdpLine
+	{
+		absl::string_view text;
+
+		// offsets of this line and of the next one in the SDP
+		size_t begin = 0;
+		size_t next = 0;
+
+		// 'v', 'm', 'a', ..., 0 for a malformed line
+		char type() const { return text.size() >= 2 && text[1] == '=' ? text[0] : 0; }
+
+		absl::string_view value() const { return type() ? text.substr(2) : absl::string_view(); }
+	};
+
+	// Single pass over the lines of an SDP, "\r\n" and "\n" terminated alike. Allocates nothing,
+	// the SDP has to outlive the scanner and the lines it returned.
+	class SdpScanner
+	{
+	public:
+		explicit SdpScanner(absl::string_view sdp, size_t begin = 0, size_t end = absl::string_view::npos);
+
+		bool next(SdpLine& line);
+
+	private:
+		absl::string_view _sdp;
+
+		size_t _pos;
+
+		size_t _end;
+	};
+
+	// A media section, from its m-line up to the next one.
+	struct SdpMediaSection
+	{
+		// "audio", "video", "application"
+		absl::string_view media;
+
+		// [begin, end) in the SDP, the m-line included
+		size_t begin = 0;
+		size_t end = 0;
+	};
+
+	class SDPUtils
 	{
 	public:
-		static std::vector<std::string> split(const std::string& str, char delim);
+		// "m=video 9 UDP/TLS/RTP/SAVPF 96 97" -> media "video", formats "96 97"
+		static bool parseMediaLine(absl::string_view line, absl::string_view& media, absl::string_view& formats);
+
+		// "a=ssrc:1234 cname:abc" -> ssrc "1234", attribute "cname", value "abc"
+		static bool parseSsrcAttribute(absl::string_view line, absl::string_view& ssrc, absl::string_view& attribute, absl::string_view& value);
+
+		// "a=ssrc-group:FID 1234 5678" -> semantics "FID", ssrcs "1234 5678"
+		static bool parseSsrcGroup(absl::string_view line, absl::string_view& semantics, absl::string_view& ssrcs);
+
+		// "a=rtpmap:96 VP8/90000" -> name "rtpmap", value "96 VP8/90000", "a=sendrecv" -> name "sendrecv", value ""
+		static bool parseAttribute(absl::string_view line, absl::string_view& name, absl::string_view& value);
+
+		static std::vector<SdpMediaSection> mediaSections(absl::string_view sdp);
 
-		static std::string join(const std::vector<std::string>& lines, const std::string& separator = "\n");
+		// Adds |simulcast| more ssrcs, with FID ones if the first ssrc has one, and their "a=ssrc-group:SIM"
+		// at the end of the first video section. False if there is nothing to inject into or it is already there.
+		static bool injectSimulcast(int64_t simulcast, std::string& sdp);
 
-		static void injectSimulcast(int64_t simulcast, std::vector<std::string>& lines);
+		// Moves the payload types of |codec| ("VP8", "H264", ...) to the front of the m-lines of |media|,
+		// so that it is the one negotiated. False if nothing had to move.
+		static bool preferCodec(std::string& sdp, absl::string_view media, absl::string_view codec);
 	};
-}
\ No newline at end of file
+}
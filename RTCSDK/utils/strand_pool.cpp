@@ -0,0 +1,105 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#include "strand_pool.h"
+#include <algorithm>
+#include "rtc_base/time_utils.h"
+#include "rtc_base/platform_thread_types.h"
+
+namespace vi {
+	StrandPool::StrandPool(const std::string& name, size_t threadCount)
+		: _state(std::make_shared<State>())
+	{
+		threadCount = std::max<size_t>(1, threadCount);
+		for (size_t i = 0; i < threadCount; ++i) {
+			_workers.emplace_back([state = _state, name = name + "-" + std::to_string(i)]() {
+				rtc::SetCurrentThreadName(name.c_str());
+				run(state);
+			});
+		}
+	}
+
+	StrandPool::~StrandPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_state->mutex);
+			_state->stopped = true;
+		}
+		_state->cv.notify_all();
+		for (auto& worker : _workers) {
+			if (worker.get_id() == std::this_thread::get_id()) {
+				worker.detach();
+			}
+			else if (worker.joinable()) {
+				worker.join();
+			}
+		}
+	}
+
+	void StrandPool::post(int64_t key, Task task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_state->mutex);
+			if (_state->stopped) {
+				return;
+			}
+			auto& strand = _state->strands[key];
+			if (!strand) {
+				strand = std::make_shared<Strand>();
+			}
+			strand->tasks.emplace_back(std::move(task), rtc::TimeMillis());
+			if (strand->scheduled) {
+				return;
+			}
+			strand->scheduled = true;
+			_state->ready.emplace_back(strand);
+		}
+		_state->cv.notify_one();
+	}
+
+	void StrandPool::remove(int64_t key)
+	{
+		std::lock_guard<std::mutex> lock(_state->mutex);
+		_state->strands.erase(key);
+	}
+
+	LatencyHistogram::Snapshot StrandPool::queueLatency(int64_t key)
+	{
+		std::lock_guard<std::mutex> lock(_state->mutex);
+		auto it = _state->strands.find(key);
+		return it != _state->strands.end() ? it->second->latency.snapshot() : LatencyHistogram::Snapshot();
+	}
+
+	void StrandPool::run(std::shared_ptr<State> state)
+	{
+		std::unique_lock<std::mutex> lock(state->mutex);
+		while (true) {
+			state->cv.wait(lock, [&state]() { return state->stopped || !state->ready.empty(); });
+			if (state->stopped) {
+				return;
+			}
+
+			auto strand = state->ready.front();
+			state->ready.pop_front();
+			auto task = std::move(strand->tasks.front());
+			strand->tasks.pop_front();
+			lock.unlock();
+
+			strand->latency.add(rtc::TimeMillis() - task.second);
+			task.first();
+
+			lock.lock();
+			// one task per turn, a busy strand goes to the back so the others are not starved
+			if (!strand->tasks.empty()) {
+				state->ready.emplace_back(strand);
+				state->cv.notify_one();
+			}
+			else {
+				strand->scheduled = false;
+			}
+		}
+	}
+}
@@ -0,0 +1,73 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "latency_histogram.h"
+
+namespace vi {
+	// A small worker pool where tasks posted with the same key (a strand) run one at a time in
+	// posting order, while tasks of different keys run in parallel.
+	class StrandPool
+	{
+	public:
+		using Task = std::function<void()>;
+
+		StrandPool(const std::string& name, size_t threadCount);
+
+		~StrandPool();
+
+		void post(int64_t key, Task task);
+
+		// Forgets the strand of |key|, tasks already queued still run.
+		void remove(int64_t key);
+
+		// Time tasks of |key| spent queued before a worker picked them up.
+		LatencyHistogram::Snapshot queueLatency(int64_t key);
+
+	private:
+		struct Strand {
+			std::deque<std::pair<Task, int64_t>> tasks;
+			// queued in |ready| or being run by a worker
+			bool scheduled = false;
+			LatencyHistogram latency;
+		};
+
+		// Outlives the pool while a worker still runs, the pool may be released by one of its own tasks.
+		struct State {
+			std::mutex mutex;
+
+			std::condition_variable cv;
+
+			std::unordered_map<int64_t, std::shared_ptr<Strand>> strands;
+
+			// strands with pending tasks, each strand appears at most once
+			std::deque<std::shared_ptr<Strand>> ready;
+
+			bool stopped = false;
+		};
+
+		StrandPool(const StrandPool&) = delete;
+
+		StrandPool& operator=(const StrandPool&) = delete;
+
+		static void run(std::shared_ptr<State> state);
+
+	private:
+		std::shared_ptr<State> _state;
+
+		std::vector<std::thread> _workers;
+	};
+}
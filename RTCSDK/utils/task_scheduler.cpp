@@ -5,15 +5,98 @@
  **/
 
 #include "task_scheduler.h"
+#include <algorithm>
 #include "rtc_base/thread.h"
 
 namespace vi {
-	std::shared_ptr<TaskScheduler> TaskScheduler::create()
+	std::shared_ptr<TaskScheduler> TaskScheduler::create(rtc::Thread* thread)
 	{
-		return std::shared_ptr<TaskScheduler>(new TaskScheduler(), [thread = rtc::Thread::Current()](TaskScheduler* ptr){
+		return std::shared_ptr<TaskScheduler>(new TaskScheduler(thread), [thread = rtc::Thread::Current()](TaskScheduler* ptr){
 			thread->PostTask(RTC_FROM_HERE, [ptr]() {
 				delete ptr;
 			});
 		});
 	}
-}
\ No newline at end of file
+
+	TaskScheduler::TaskScheduler(rtc::Thread* thread)
+		: _thread(thread ? thread : TimerWheel::instance().dispatcher())
+	{
+	}
+
+	void TaskScheduler::cancel(uint64_t id)
+	{
+		std::shared_ptr<ScheduledTask> task;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			auto it = _tasks.find(id);
+			if (it == _tasks.end()) {
+				return;
+			}
+			task = it->second.lock();
+			_tasks.erase(it);
+		}
+		if (task) {
+			task->cancel();
+			TimerWheel::instance().cancel(id);
+		}
+	}
+
+	void TaskScheduler::cancelAll()
+	{
+		std::unordered_map<uint64_t, std::weak_ptr<ScheduledTask>> tasks;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			tasks.swap(_tasks);
+		}
+		for (const auto& pair : tasks) {
+			if (auto task = pair.second.lock()) {
+				task->cancel();
+				TimerWheel::instance().cancel(pair.first);
+			}
+		}
+	}
+
+	void TaskScheduler::track(std::shared_ptr<ScheduledTask> task)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_tasks.size() >= _pruneThreshold) {
+			for (auto it = _tasks.begin(); it != _tasks.end();) {
+				if (it->second.expired()) {
+					it = _tasks.erase(it);
+				}
+				else {
+					++it;
+				}
+			}
+			// amortized O(1) per schedule()
+			_pruneThreshold = std::max<size_t>(64, _tasks.size() * 2);
+		}
+		_tasks[task->getTaskId()] = task;
+	}
+
+	void TaskScheduler::arm(std::shared_ptr<ScheduledTask> task, uint32_t milliseconds)
+	{
+		if (task->cancelled()) {
+			return;
+		}
+
+		auto dispatch = [wself = weak_from_this(), thread = _thread, task, milliseconds]() {
+			thread->PostTask(RTC_FROM_HERE, [wself, task, milliseconds]() {
+				if (task->Run()) {
+					return;
+				}
+				// repetitive, the interval counts from the end of the run as before
+				if (auto self = wself.lock()) {
+					self->arm(task, milliseconds);
+				}
+			});
+		};
+
+		if (milliseconds == 0) {
+			dispatch();
+		}
+		else {
+			TimerWheel::instance().add(task->getTaskId(), milliseconds, std::move(dispatch));
+		}
+	}
+}
@@ -8,98 +8,91 @@
 
 #include <memory>
 #include <functional>
-#include <unordered_set>
+#include <atomic>
 #include <unordered_map>
 #include <mutex>
-#include "absl/memory/memory.h"
-#include <iostream>
-#include <chrono>
-#include <random>
 #include "logger/logger.h"
-#include "rtc_base/thread.h"
+#include "timer_wheel.h"
 
-namespace {
-
-	int64_t createRandomId64()
-	{
-		int64_t seed = std::chrono::system_clock::now().time_since_epoch().count();
-		std::mt19937_64 gen(seed);  
-		return gen();
-	}
+namespace rtc {
+	class Thread;
 }
 
 namespace vi {
-	class TaskScheduler;
-	template<class Closure>
-	class OneShotTask: public webrtc::QueuedTask {
+	// A task is cancelled through its own token, so a firing task never looks at the
+	// scheduler's bookkeeping or takes a lock.
+	class ScheduledTask {
 	public:
-		explicit OneShotTask(Closure&& closure, uint64_t id, std::weak_ptr<TaskScheduler> scheduler)
-			: _closure(std::forward<Closure>(closure))
-			, _id(id)
-			, _scheduler(scheduler) {
+		explicit ScheduledTask(uint64_t id) : _id(id) {}
+
+		virtual ~ScheduledTask() {}
+
+		// Returns false to be run again after the interval.
+		virtual bool Run() = 0;
+
+		void cancel() {
+			_cancelled.store(true, std::memory_order_release);
 		}
 
-		bool Run() override {
-			if (auto scheduler = _scheduler.lock()) {
-				std::unordered_set<uint64_t> ids = scheduler->getTaskIds();
-				if (ids.find(_id) != ids.end()) {
-					_closure();
-				}
-			}
-			return true;
+		bool cancelled() const {
+			return _cancelled.load(std::memory_order_acquire);
 		}
 
-		uint16_t getTaskId() {
+		uint64_t getTaskId() const {
 			return _id;
 		}
 
 	private:
-		typename std::decay<Closure>::type _closure;
 		const uint64_t _id;
-		std::weak_ptr<TaskScheduler> _scheduler;
+		std::atomic_bool _cancelled{ false };
 	};
 
 	template<class Closure>
-	class RepetitiveTask : public webrtc::QueuedTask {
+	class OneShotTask : public ScheduledTask {
 	public:
-		explicit RepetitiveTask(Closure&& closure, uint32_t milliseconds, uint64_t id, std::weak_ptr<TaskScheduler> scheduler, rtc::Thread* thread)
-			: _closure(std::forward<Closure>(closure))
-			, _milliseconds(milliseconds)
-			, _id(id)
-			, _scheduler(scheduler)
-			, _thread(thread) {
+		explicit OneShotTask(Closure&& closure, uint64_t id)
+			: ScheduledTask(id)
+			, _closure(std::forward<Closure>(closure)) {
 		}
 
 		bool Run() override {
-			bool cancelled = true;
-			if (auto scheduler = _scheduler.lock()) {
-				std::unordered_set<uint64_t> ids = scheduler->getTaskIds();
-				if (ids.find(_id) != ids.end()) {
-					cancelled = false;
-				}
-			}
-
-			if (!cancelled) {
+			if (!cancelled()) {
 				_closure();
-				_thread->PostDelayedTask(absl::WrapUnique(this), _milliseconds);
-				return false;
 			}
-			else {
+			return true;
+		}
+
+	private:
+		typename std::decay<Closure>::type _closure;
+	};
+
+	template<class Closure>
+	class RepetitiveTask : public ScheduledTask {
+	public:
+		explicit RepetitiveTask(Closure&& closure, uint64_t id)
+			: ScheduledTask(id)
+			, _closure(std::forward<Closure>(closure)) {
+		}
+
+		bool Run() override {
+			if (cancelled()) {
 				return true;
 			}
+			_closure();
+			// the closure may have cancelled itself
+			return cancelled();
 		}
 
 	private:
 		typename std::decay<Closure>::type _closure;
-		const uint32_t _milliseconds;
-		const uint64_t _id;
-		rtc::Thread* const _thread;
-		std::weak_ptr<TaskScheduler> _scheduler;
 	};
 
+	// Timers live in the process-wide TimerWheel, a scheduler only owns its task ids and the
+	// thread its tasks run on, so creating one does not start a thread.
 	class TaskScheduler : public std::enable_shared_from_this<TaskScheduler> {
 	public:
-		static std::shared_ptr<TaskScheduler> create();
+		// Tasks run on |thread|, or on the shared dispatcher thread of the timer wheel if null.
+		static std::shared_ptr<TaskScheduler> create(rtc::Thread* thread = nullptr);
 
 		~TaskScheduler() {
 			DLOG("~TaskScheduler()");
@@ -108,83 +101,38 @@ namespace vi {
 
 		template <class Closure>
 		uint64_t schedule(Closure&& closure, uint32_t milliseconds = 0, bool repetitive = false) {
+			uint64_t id = TimerWheel::nextId();
+			std::shared_ptr<ScheduledTask> task;
 			if (!repetitive) {
-				return scheduleOneShotTask(std::forward<Closure>(closure), milliseconds);
+				task = std::make_shared<OneShotTask<Closure>>(std::forward<Closure>(closure), id);
 			}
 			else {
-				return scheduleRepetitiveTask(std::forward<Closure>(closure), milliseconds);
-			}
-		}
-
-		void cancel(uint64_t id) {
-			std::lock_guard<std::mutex> lock(_mutex);
-			if (_taskIdSet.find(id) != _taskIdSet.end()) {
-				_taskIdSet.erase(id);
+				task = std::make_shared<RepetitiveTask<Closure>>(std::forward<Closure>(closure), id);
 			}
+			track(task);
+			arm(task, milliseconds);
+			return id;
 		}
 
-		void cancelAll() {
-			std::lock_guard<std::mutex> lock(_mutex);
-			_thread->Stop();
-			_taskIdSet.clear();
-		}
+		void cancel(uint64_t id);
 
-		const std::unordered_set<uint64_t>& getTaskIds() {
-			std::lock_guard<std::mutex> lock(_mutex);
-			return _taskIdSet;
-		}
+		void cancelAll();
 
 	private:
-		TaskScheduler() {
-			init();
-		}
-
-		void init() {
-			std::string schedulerId = "post-" + std::to_string((uint64_t)this);
-			_thread = rtc::Thread::Create();
-			_thread->SetName(schedulerId, nullptr);
-			_thread->Start();
-		}
+		explicit TaskScheduler(rtc::Thread* thread);
 
-		template <class Closure>
-		uint64_t scheduleOneShotTask(Closure&& closure, uint32_t milliseconds) {
-			uint64_t id = createRandomId64();
-			auto task = createOneShotTask(std::forward<Closure>(closure), id);
-			{
-				std::lock_guard<std::mutex> lock(_mutex);
-				_taskIdSet.emplace(id);
-			}
-			_thread->PostDelayedTask(std::move(task), milliseconds);
+		// Hands |task| to the wheel, and from the wheel to |_thread| once it is due.
+		void arm(std::shared_ptr<ScheduledTask> task, uint32_t milliseconds);
 
-			return id;
-		}
-
-		template <class Closure>
-		uint64_t scheduleRepetitiveTask(Closure&& closure, uint32_t milliseconds) {
-			uint64_t id = createRandomId64();
-			auto task = createRepetitiveTask(std::forward<Closure>(closure), milliseconds, id);
-			{
-				std::lock_guard<std::mutex> lock(_mutex);
-				_taskIdSet.emplace(id);
-			}
-			_thread->PostDelayedTask(std::move(task), milliseconds);
-			return id;
-		}
-
-		template <typename Closure>
-		std::unique_ptr<webrtc::QueuedTask> createOneShotTask(Closure&& closure, uint64_t id) {
-			return std::make_unique<OneShotTask<Closure>>(std::forward<Closure>(closure), id, weak_from_this());
-		}
-
-		template <typename Closure>
-		std::unique_ptr<webrtc::QueuedTask> createRepetitiveTask(Closure&& closure, uint32_t milliseconds, uint64_t id) {
-			return std::make_unique<RepetitiveTask<Closure>>(std::forward<Closure>(closure), milliseconds, id, weak_from_this(), _thread.get());
-		}
+		// Indexes |task| for cancel(), dropping the entries of finished tasks now and then.
+		void track(std::shared_ptr<ScheduledTask> task);
 
 	private:
 		std::mutex _mutex;
-		std::unordered_set<uint64_t> _taskIdSet;
-		std::shared_ptr<rtc::Thread> _thread;
+		// only cancel() looks tasks up, a finished task's entry expires with the task
+		std::unordered_map<uint64_t, std::weak_ptr<ScheduledTask>> _tasks;
+		size_t _pruneThreshold = 64;
+		rtc::Thread* _thread;
 	};
 
 }
\ No newline at end of file
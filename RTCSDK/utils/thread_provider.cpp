@@ -10,6 +10,7 @@
 #include "rtc_base/win32_socket_init.h"
 #include "rtc_base/physical_socket_server.h"
 #include "logger/logger.h"
+#include "strand_pool.h"
 
 namespace vi {
 	ThreadProvider::ThreadProvider() : _destroy(true), _inited(false)
@@ -30,6 +31,8 @@ namespace vi {
 		std::lock_guard<std::mutex> lock(_mutex);
 
 		_mainThread = rtc::ThreadManager::Instance()->CurrentThread();
+		_handles["main"] = 1;
+		_table[1].store(_mainThread, std::memory_order_release);
 
 		_inited = true;
 	}
@@ -49,9 +52,24 @@ namespace vi {
 		}
 
 		for (const auto& name : threadNames) {
+			ThreadHandle handle = kInvalidThreadHandle;
+			auto it = _handles.find(name);
+			if (it != _handles.end()) {
+				handle = it->second;
+			}
+			else if (_handles.size() + 1 < kMaxThreads) {
+				handle = (ThreadHandle)_handles.size() + 1;
+				_handles[name] = handle;
+			}
+			else {
+				ELOG("too many threads, {} is not created", name);
+				continue;
+			}
+
 			_threadsMap[name] = rtc::Thread::Create();
 			_threadsMap[name]->SetName(name, nullptr);
 			_threadsMap[name]->Start();
+			_table[handle].store(_threadsMap[name].get(), std::memory_order_release);
 		}
 	}
 
@@ -60,6 +78,7 @@ namespace vi {
 		std::lock_guard<std::mutex> lock(_mutex);
 
 		for (const auto& thread : _threadsMap) {
+			_table[_handles[thread.first]].store(nullptr, std::memory_order_release);
 			thread.second->Stop();
 		}
 		_threadsMap.clear();
@@ -67,17 +86,38 @@ namespace vi {
 		_destroy = true;
 	}
 
-	rtc::Thread* ThreadProvider::thread(const std::string& name)
+	ThreadHandle ThreadProvider::handle(const std::string& name)
 	{
 		std::lock_guard<std::mutex> lock(_mutex);
 
-		if (name == "main") {
-			return _mainThread;
-		} 
-		else if (_threadsMap.find(name) != _threadsMap.end()) {
-			return _threadsMap[name].get();
+		auto it = _handles.find(name);
+		if (it == _handles.end()) {
+			ELOG("unknown thread: {}", name);
+			return kInvalidThreadHandle;
+		}
+		return it->second;
+	}
+
+	rtc::Thread* ThreadProvider::thread(ThreadHandle handle)
+	{
+		if (handle == kInvalidThreadHandle || handle >= kMaxThreads) {
+			return nullptr;
 		}
+		return _table[handle].load(std::memory_order_acquire);
+	}
 
-		return nullptr;
+	rtc::Thread* ThreadProvider::thread(const std::string& name)
+	{
+		return thread(handle(name));
+	}
+
+	std::shared_ptr<StrandPool> ThreadProvider::closePool()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (!_closePool) {
+			_closePool = std::make_shared<StrandPool>("pc-close", kClosePoolSize);
+		}
+		return _closePool;
 	}
-}
\ No newline at end of file
+}
@@ -11,10 +11,17 @@
 #include <atomic>
 #include <string>
 #include <list>
+#include <array>
 #include "rtc_base/thread.h"
 #include "service/rtc_engine.h"
 
 namespace vi {
+	class StrandPool;
+
+	// A thread name interned by ThreadProvider, stable for the provider's lifetime.
+	using ThreadHandle = uint32_t;
+
+	constexpr ThreadHandle kInvalidThreadHandle = 0;
 
 	class ThreadProvider
 	{
@@ -29,8 +36,18 @@ namespace vi {
 
 		void create(const std::list<std::string>& threadNames);
 
+		// Returns kInvalidThreadHandle for a name that was never created, resolve it once and keep it.
+		ThreadHandle handle(const std::string& name);
+
+		// Lock-free, nullptr once the thread is stopped.
+		rtc::Thread* thread(ThreadHandle handle);
+
 		rtc::Thread* thread(const std::string& name);
 
+		// Where the PeerConnections of this engine are closed in parallel, see TeardownCoordinator.
+		// Created on first use.
+		std::shared_ptr<StrandPool> closePool();
+
 	private:
 		ThreadProvider(const ThreadProvider&) = delete;
 
@@ -42,10 +59,21 @@ namespace vi {
 		void stopAll();
 
 	private:
+		static constexpr size_t kMaxThreads = 32;
+
+		static constexpr size_t kClosePoolSize = 4;
+
 		std::unordered_map<std::string, std::shared_ptr<rtc::Thread>> _threadsMap;
+
+		std::unordered_map<std::string, ThreadHandle> _handles;
+
+		// indexed by handle, slot 0 stays empty
+		std::array<std::atomic<rtc::Thread*>, kMaxThreads> _table{};
 		
 		std::mutex _mutex;
 
+		std::shared_ptr<StrandPool> _closePool;
+
 		rtc::Thread* _mainThread = nullptr;
 
 		std::atomic_bool _inited;
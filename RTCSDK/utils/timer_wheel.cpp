@@ -0,0 +1,208 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#include "timer_wheel.h"
+#include <algorithm>
+#include <chrono>
+#include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
+
+namespace vi {
+	TimerWheel& TimerWheel::instance()
+	{
+		// never destroyed, schedulers may still cancel their timers from static destructors
+		static TimerWheel* wheel = new TimerWheel();
+		return *wheel;
+	}
+
+	uint64_t TimerWheel::nextId()
+	{
+		static std::atomic<uint64_t> id{ 0 };
+		return ++id;
+	}
+
+	TimerWheel::TimerWheel()
+	{
+		_currentTick = nowTick();
+		_dispatcher = rtc::Thread::Create();
+		_dispatcher->SetName("timer-dispatch", nullptr);
+		_dispatcher->Start();
+		_driver = std::thread(&TimerWheel::run, this);
+	}
+
+	TimerWheel::~TimerWheel()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopped = true;
+		}
+		_cv.notify_one();
+		if (_driver.joinable()) {
+			_driver.join();
+		}
+		_dispatcher->Stop();
+	}
+
+	uint64_t TimerWheel::nowTick()
+	{
+		return (uint64_t)(rtc::TimeMillis() / kTickMs);
+	}
+
+	void TimerWheel::add(uint64_t id, uint32_t milliseconds, Callback callback)
+	{
+		const uint64_t ticks = std::max<uint64_t>(1, (milliseconds + kTickMs - 1) / kTickMs);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			auto it = _timers.find(id);
+			if (it != _timers.end()) {
+				unlink(it->second.get());
+				_timers.erase(it);
+			}
+			if (_timers.empty()) {
+				// nothing is armed, the wheel can jump to now without expiring anything
+				_currentTick = nowTick();
+			}
+
+			const uint64_t range = (1ull << (kSlotBits * kLevels)) - 1;
+			auto timer = std::make_unique<Timer>();
+			timer->id = id;
+			timer->expiry = std::min(nowTick() + ticks, _currentTick + range);
+			timer->callback = std::move(callback);
+			place(timer.get());
+			_timers[id] = std::move(timer);
+		}
+		_cv.notify_one();
+	}
+
+	bool TimerWheel::cancel(uint64_t id)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _timers.find(id);
+		if (it == _timers.end()) {
+			return false;
+		}
+		unlink(it->second.get());
+		_timers.erase(it);
+		return true;
+	}
+
+	size_t TimerWheel::size()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _timers.size();
+	}
+
+	void TimerWheel::place(Timer* timer)
+	{
+		const uint64_t delta = timer->expiry > _currentTick ? timer->expiry - _currentTick : 0;
+		size_t level = 0;
+		while (level + 1 < kLevels && delta >= (1ull << (kSlotBits * (level + 1)))) {
+			++level;
+		}
+		// an overdue timer lands in the slot of the current tick, which is expired right after cascading
+		const uint64_t expiry = std::max(timer->expiry, _currentTick);
+		Timer** head = &_slots[level][(expiry >> (kSlotBits * level)) & kSlotMask];
+
+		timer->head = head;
+		timer->prev = nullptr;
+		timer->next = *head;
+		if (*head) {
+			(*head)->prev = timer;
+		}
+		*head = timer;
+	}
+
+	void TimerWheel::unlink(Timer* timer)
+	{
+		if (timer->prev) {
+			timer->prev->next = timer->next;
+		}
+		else {
+			*timer->head = timer->next;
+		}
+		if (timer->next) {
+			timer->next->prev = timer->prev;
+		}
+		timer->head = nullptr;
+		timer->prev = nullptr;
+		timer->next = nullptr;
+	}
+
+	void TimerWheel::cascade(size_t level)
+	{
+		Timer** head = &_slots[level][(_currentTick >> (kSlotBits * level)) & kSlotMask];
+		Timer* timer = *head;
+		*head = nullptr;
+		while (timer) {
+			Timer* next = timer->next;
+			place(timer);
+			timer = next;
+		}
+	}
+
+	void TimerWheel::step(std::vector<Callback>& expired)
+	{
+		++_currentTick;
+		for (size_t level = 1; level < kLevels; ++level) {
+			if ((_currentTick & ((1ull << (kSlotBits * level)) - 1)) != 0) {
+				break;
+			}
+			cascade(level);
+		}
+
+		Timer** head = &_slots[0][_currentTick & kSlotMask];
+		Timer* timer = *head;
+		*head = nullptr;
+		while (timer) {
+			Timer* next = timer->next;
+			expired.emplace_back(std::move(timer->callback));
+			_timers.erase(timer->id);
+			timer = next;
+		}
+	}
+
+	void TimerWheel::run()
+	{
+		std::vector<Callback> expired;
+		std::unique_lock<std::mutex> lock(_mutex);
+		while (!_stopped) {
+			if (_timers.empty()) {
+				_cv.wait(lock);
+				continue;
+			}
+
+			const uint64_t now = nowTick();
+			while (_currentTick < now && !_timers.empty()) {
+				step(expired);
+			}
+
+			if (!expired.empty()) {
+				lock.unlock();
+				for (auto& callback : expired) {
+					callback();
+				}
+				expired.clear();
+				lock.lock();
+				continue;
+			}
+
+			if (_timers.empty()) {
+				continue;
+			}
+
+			// sleep until the next occupied slot of the lowest level, or the next cascade
+			const uint64_t boundary = (_currentTick | kSlotMask) + 1;
+			uint64_t deadline = _currentTick + 1;
+			while (deadline < boundary && !_slots[0][deadline & kSlotMask]) {
+				++deadline;
+			}
+			const int64_t waitMs = (int64_t)deadline * kTickMs - rtc::TimeMillis();
+			if (waitMs > 0) {
+				_cv.wait_for(lock, std::chrono::milliseconds(waitMs));
+			}
+		}
+	}
+}
@@ -0,0 +1,107 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace rtc {
+	class Thread;
+}
+
+namespace vi {
+	// Process-wide hierarchical timer wheel (4 levels of 64 slots, 10 ms ticks, ~46 hours of range)
+	// driven by a single thread. Expired callbacks run on the driver thread and are expected to
+	// only hand work over to another thread, see TaskScheduler.
+	class TimerWheel
+	{
+	public:
+		using Callback = std::function<void()>;
+
+		static constexpr int64_t kTickMs = 10;
+
+		static TimerWheel& instance();
+
+		// Unique across the process, usable as the id of add().
+		static uint64_t nextId();
+
+		// Arms |callback| to fire once after |milliseconds|, an armed timer with the same id is replaced.
+		void add(uint64_t id, uint32_t milliseconds, Callback callback);
+
+		// O(1), returns false if the timer already fired or was never armed.
+		bool cancel(uint64_t id);
+
+		size_t size();
+
+		// Shared thread that runs the tasks of schedulers created without a target thread.
+		rtc::Thread* dispatcher() { return _dispatcher.get(); }
+
+	private:
+		static constexpr size_t kLevels = 4;
+
+		static constexpr size_t kSlotBits = 6;
+
+		static constexpr size_t kSlots = 1 << kSlotBits;
+
+		static constexpr uint64_t kSlotMask = kSlots - 1;
+
+		struct Timer {
+			uint64_t id = 0;
+			uint64_t expiry = 0;
+			Callback callback;
+			Timer** head = nullptr;
+			Timer* prev = nullptr;
+			Timer* next = nullptr;
+		};
+
+		TimerWheel();
+
+		~TimerWheel();
+
+		TimerWheel(const TimerWheel&) = delete;
+
+		TimerWheel& operator=(const TimerWheel&) = delete;
+
+		static uint64_t nowTick();
+
+		void run();
+
+		void place(Timer* timer);
+
+		void unlink(Timer* timer);
+
+		void cascade(size_t level);
+
+		// Advances one tick, moving the expired timers to |expired|.
+		void step(std::vector<Callback>& expired);
+
+	private:
+		std::mutex _mutex;
+
+		std::condition_variable _cv;
+
+		std::array<std::array<Timer*, kSlots>, kLevels> _slots{};
+
+		std::unordered_map<uint64_t, std::unique_ptr<Timer>> _timers;
+
+		uint64_t _currentTick = 0;
+
+		bool _stopped = false;
+
+		std::unique_ptr<rtc::Thread> _dispatcher;
+
+		std::thread _driver;
+	};
+}
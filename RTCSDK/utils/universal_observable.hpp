@@ -1,154 +1,156 @@
-
 #pragma once
 
 #include <type_traits>
-#include <list>
+#include <vector>
+#include <memory>
+#include <mutex>
 #include <algorithm>
-#include "absl/types/any.h"
 #include "absl/types/optional.h"
 #include "utils/thread_provider.h"
-#include "rtc_base/deprecated/recursive_critical_section.h"
 
 namespace vi {
+    // Observers are kept in an immutable snapshot that is replaced on every change (copy on write),
+    // so notifying only loads the current snapshot and never waits for a registration. The thread
+    // of an observer is resolved once when it registers.
     template<typename Observer>
     class UniversalObservable {
     public:
         using observer_ptr = std::shared_ptr<Observer>;
-        void addWeakObserver(const observer_ptr &observer, absl::optional<std::string> threadName) {
-            rtc::CritScope scope(&_criticalSection);
-            if (!hasObserverInternal(observer)) {
-                WeakObject wobj(observer, threadName);
-                _observers.emplace_back(wobj);
+        // An observer on a null thread is not added.
+        void addWeakObserver(const observer_ptr &observer, rtc::Thread* thread) {
+            if (thread) {
+                add(Entry(observer, false, thread));
             }
         }
-        
-        void addObserver(const observer_ptr &observer, absl::optional<std::string> threadName) {
-            rtc::CritScope scope(&_criticalSection);
-            if (!hasObserverInternal(observer)) {
-                Object obj(observer, threadName);
-                _observers.emplace_back(obj);
+
+        void addObserver(const observer_ptr &observer, rtc::Thread* thread) {
+            if (thread) {
+                add(Entry(observer, true, thread));
             }
         }
-        
+
+        // Thread names are looked up in the default engine, SDK components pass their own threads.
+        void addWeakObserver(const observer_ptr &observer, absl::optional<std::string> threadName) {
+            addWeakObserver(observer, resolve(threadName));
+        }
+
+        void addObserver(const observer_ptr &observer, absl::optional<std::string> threadName) {
+            addObserver(observer, resolve(threadName));
+        }
+
         void removeObserver(const observer_ptr &observer) {
-            rtc::CritScope scope(&_criticalSection);
-            for (auto it = _observers.begin(); it != _observers.end(); ++it) {
-                auto var = absl::any(*it);
-                if (var.has_value()) {
-                    if (absl::any_cast<WeakObject>(&var)) {
-                        WeakObject wobj = absl::any_cast<WeakObject>(var);
-                        if (wobj.observer.lock() == observer) {
-                            _observers.erase(it);
-                            return;
-                        }
-                    } else if (absl::any_cast<Object>(&var)) {
-                        Object obj = absl::any_cast<Object>(var);
-                        if (obj.observer == observer) {
-                            _observers.erase(it);
-                            return;
-                        }
-                    }
+            update([&observer](Snapshot& observers) {
+                auto it = std::find_if(observers.begin(), observers.end(), [&observer](const Entry& entry) {
+                    return entry.get() == observer;
+                });
+                if (it != observers.end()) {
+                    observers.erase(it);
                 }
-            }
+            });
         }
-        
+
         void clearObserver() {
-            rtc::CritScope scope(&_criticalSection);
-            _observers.clear();
+            update([](Snapshot& observers) {
+                observers.clear();
+            });
         }
-        
+
         size_t numOfObservers() {
-            rtc::CritScope scope(&_criticalSection);
-            return _observers.size();
+            return load()->size();
         }
-        
+
         bool hasObserver(const observer_ptr &observer) {
-            rtc::CritScope scope(&_criticalSection);
-            return hasObserverInternal(observer);
+            return hasObserverInternal(*load(), observer);
         }
-        
+
     protected:
-        bool hasObserverInternal(const observer_ptr &observer) {
-            for (auto it = _observers.begin(); it != _observers.end(); ++it) {
-				auto var = absl::any(*it);
-                if (var.has_value()) {
-                    if (absl::any_cast<WeakObject>(&var)) {
-                        WeakObject wobj = absl::any_cast<WeakObject>(var);
-                        if (wobj.observer.lock() == observer) {
-                            return true;
-                        }
-                    } else if (absl::any_cast<Object>(&var)) {
-                        Object obj = absl::any_cast<Object>(var);
-                        if (obj.observer == observer) {
-                            return true;
-                        }
-                    }
+        // |notifier| is called in place for observers living on the current thread, and
+        // posted (as a copy) to the thread of every other observer.
+        template<typename Notifier>
+        void notifyObservers(Notifier&& notifier) const {
+            const auto observers = load();
+            for (const auto &entry : *observers) {
+                std::shared_ptr<Observer> obs = entry.get();
+                if (!obs) {
+                    continue;
                 }
-            }
-            
-            return false;
-        }
-        
-    protected:
-        virtual void notifyObservers(std::function<void(const observer_ptr &)> notifier) const {
-            decltype(_observers) observers;
-            {
-                rtc::CritScope scope(&_criticalSection);
-                observers = _observers;
-            }
-            
-            for (const auto &observer: observers) {
-                auto var = absl::any(observer);
-                if (var.has_value()) {
-                    std::shared_ptr<Observer> obs;
-                    absl::optional<std::string> threadName;
-                    
-                    if (absl::any_cast<WeakObject>(&var)) {
-                        WeakObject wobj = absl::any_cast<WeakObject>(var);
-                        obs = wobj.observer.lock();
-                        threadName = wobj.threadName;
-                    } else if (absl::any_cast<Object>(&var)) {
-                        Object obj = absl::any_cast<Object>(var);
-                        obs = obj.observer;
-                        threadName = obj.threadName;
-                    }
-                    
-                    if (obs) {
-						rtc::Thread* thread = TMgr->thread(threadName.value_or(""));
-						assert(thread);
-						if (thread->IsCurrent()) {
-                            notifier(obs);
-						}
-						else {
-                            //notifier(obs);
-							thread->PostTask(RTC_FROM_HERE, [wobs = std::weak_ptr<Observer>(obs), notifier]() {
-								if (auto observer = wobs.lock()) {
-                                    notifier(observer);
-								}
-							});
-						}
-                    }
+                if (entry.thread->IsCurrent()) {
+                    notifier(obs);
+                }
+                else {
+                    entry.thread->PostTask(RTC_FROM_HERE, [wobs = std::weak_ptr<Observer>(obs), notifier]() {
+                        if (auto observer = wobs.lock()) {
+                            notifier(observer);
+                        }
+                    });
                 }
             }
         }
-        
+
     private:
-        template<typename T = std::shared_ptr<Observer>>
-        class InnerObject {
+        class Entry {
         public:
-            InnerObject(std::shared_ptr<Observer> o, absl::optional<std::string> name)
-            : observer(o)
-            , threadName(name) {
+            Entry(const std::shared_ptr<Observer>& o, bool retain, rtc::Thread* t)
+            : weak(o)
+            , strong(retain ? o : nullptr)
+            , thread(t) {
+            }
+
+            std::shared_ptr<Observer> get() const {
+                return strong ? strong : weak.lock();
+            }
+
+            bool expired() const {
+                return !strong && weak.expired();
             }
-            
-            T observer;
-            absl::optional<std::string> threadName;
+
+            std::weak_ptr<Observer> weak;
+            // set for observers added by addObserver(), which are kept alive
+            std::shared_ptr<Observer> strong;
+            rtc::Thread* thread;
         };
-        
-        using WeakObject = InnerObject<std::weak_ptr<Observer>>;
-        using Object = InnerObject<std::shared_ptr<Observer>>;
-        
-        rtc::RecursiveCriticalSection _criticalSection;
-        std::list<absl::any> _observers;
+
+        using Snapshot = std::vector<Entry>;
+
+        static rtc::Thread* resolve(const absl::optional<std::string>& threadName) {
+            auto provider = TMgr;
+            return provider->thread(provider->handle(threadName.value_or("")));
+        }
+
+        static bool hasObserverInternal(const Snapshot& observers, const observer_ptr &observer) {
+            return std::any_of(observers.begin(), observers.end(), [&observer](const Entry& entry) {
+                return entry.get() == observer;
+            });
+        }
+
+        void add(Entry&& entry) {
+            update([&entry](Snapshot& observers) {
+                if (!hasObserverInternal(observers, entry.get())) {
+                    observers.emplace_back(std::move(entry));
+                }
+            });
+        }
+
+        std::shared_ptr<const Snapshot> load() const {
+            return std::atomic_load(&_observers);
+        }
+
+        // Writers are serialized, each one publishes a new snapshot and drops dead weak entries.
+        template<typename Mutator>
+        void update(Mutator&& mutator) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto observers = std::make_shared<Snapshot>();
+            observers->reserve(_observers->size() + 1);
+            for (const auto& entry : *_observers) {
+                if (!entry.expired()) {
+                    observers->emplace_back(entry);
+                }
+            }
+            mutator(*observers);
+            std::atomic_store(&_observers, std::shared_ptr<const Snapshot>(std::move(observers)));
+        }
+
+        std::mutex _mutex;
+        std::shared_ptr<const Snapshot> _observers = std::make_shared<const Snapshot>();
     };
 }
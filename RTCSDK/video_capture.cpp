@@ -14,7 +14,6 @@
 #include "api/video/video_rotation.h"
 #include "rtc_base/async_invoker.h"
 #include "logger/logger.h"
-#include "utils/thread_provider.h"
 
 namespace vi {
 
@@ -95,9 +94,9 @@ namespace vi {
 		}
 	}
 
-	VcmCapturer::VcmCapturer() 
+	VcmCapturer::VcmCapturer(rtc::Thread* thread)
 		: vcm_(nullptr)
-		, thread_(TMgr->thread("capture-session"))
+		, thread_(thread)
 	{
 
 	}
@@ -142,8 +141,9 @@ namespace vi {
 	VcmCapturer* VcmCapturer::Create(size_t width,
 		size_t height,
 		size_t target_fps,
-		size_t capture_device_index) {
-		std::unique_ptr<VcmCapturer> vcm_capturer(new VcmCapturer());
+		size_t capture_device_index,
+		rtc::Thread* thread) {
+		std::unique_ptr<VcmCapturer> vcm_capturer(new VcmCapturer(thread));
 		if (!vcm_capturer->Init(width, height, target_fps, capture_device_index)) {
 			RTC_LOG(LS_WARNING) << "Failed to create VcmCapturer(w = " << width
 				<< ", h = " << height << ", fps = " << target_fps
@@ -156,14 +156,24 @@ namespace vi {
 	void VcmCapturer::Destroy() {
 		if (!vcm_)
 			return;
-		DLOG("destroy capture source1");
-
-		thread_->Invoke<int32_t>(RTC_FROM_HERE, std::bind(&VcmCapturer::_stopCapture, this));
+		DLOG("destroy capture source");
 
-		vcm_->DeRegisterCaptureDataCallback(); DLOG("destroy capture source3");
+		// No frame reaches |this| once deregistered, so stopping and releasing the module
+		// is left to the capture thread instead of being waited for.
+		vcm_->DeRegisterCaptureDataCallback();
 
-		// Release reference to VCM.
-		thread_->Invoke<void>(RTC_FROM_HERE, std::bind(&VcmCapturer::_release, this));
+		rtc::scoped_refptr<VideoCaptureModule> vcm = vcm_;
+		vcm_ = nullptr;
+		auto release = [vcm]() mutable {
+			vcm->StopCapture();
+			vcm = nullptr;
+		};
+		if (thread_->IsCurrent()) {
+			release();
+		}
+		else {
+			thread_->PostTask(RTC_FROM_HERE, std::move(release));
+		}
 	}
 
 	VcmCapturer::~VcmCapturer() {
@@ -182,14 +192,4 @@ namespace vi {
 	int32_t VcmCapturer::_startCapture() {
 		return vcm_->StartCapture(capability_);
 	}
-
-	int32_t VcmCapturer::_stopCapture() {
-		return vcm_->StopCapture();
-	}
-
-	void  VcmCapturer::_release() {
-		DLOG("destroy capture source4");
-		vcm_ = nullptr;
-		DLOG("destroy capture source5");
-	}
 }
@@ -58,16 +58,18 @@ namespace vi {
 
 	class VcmCapturer : public SimpleVideoCapturer, public rtc::VideoSinkInterface<VideoFrame> {
 	public:
+		// The capture module is driven from |thread|, the "capture-session" thread of the engine.
 		static VcmCapturer* Create(size_t width,
 			size_t height,
 			size_t target_fps,
-			size_t capture_device_index);
+			size_t capture_device_index,
+			rtc::Thread* thread);
 		virtual ~VcmCapturer();
 
 		void OnFrame(const VideoFrame& frame) override;
 
 	private:
-		VcmCapturer();
+		explicit VcmCapturer(rtc::Thread* thread);
 		bool Init(size_t width,
 			size_t height,
 			size_t target_fps,
@@ -78,21 +80,17 @@ namespace vi {
 
 		int32_t _startCapture();
 
-		int32_t _stopCapture();
-
-		void _release();
-
 	private:
 		rtc::scoped_refptr<VideoCaptureModule> vcm_;
 		VideoCaptureCapability capability_;
-		std::unique_ptr<rtc::Thread> thread_;
+		rtc::Thread* thread_;
 	};
 
 	class CapturerTrackSource : public webrtc::VideoTrackSource {
 	public:
 		~CapturerTrackSource() {}
 
-		static rtc::scoped_refptr<CapturerTrackSource> Create() {
+		static rtc::scoped_refptr<CapturerTrackSource> Create(rtc::Thread* thread) {
 			const size_t kWidth = 640;
 			const size_t kHeight = 480;
 			const size_t kFps = 30;
@@ -105,7 +103,7 @@ namespace vi {
 			int num_devices = info->NumberOfDevices();
 			for (int i = 0; i < num_devices; ++i) {
 				capturer = absl::WrapUnique(
-					VcmCapturer::Create(kWidth, kHeight, kFps, i));
+					VcmCapturer::Create(kWidth, kHeight, kFps, i, thread));
 				if (capturer) {
 					return new rtc::RefCountedObject<CapturerTrackSource>(
 						std::move(capturer));
@@ -0,0 +1,48 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "absl/types/optional.h"
+
+namespace vi {
+	// One encoding of the published video track. Several of them are rid based simulcast, a single one
+	// with |scalabilityMode| is VP9/AV1 SVC. Unset fields are left to WebRTC.
+	struct VideoLayer {
+		// "h", "m", "l", has to be unique when there are several layers
+		std::string rid;
+
+		bool active = true;
+
+		absl::optional<int> maxBitrateBps;
+
+		absl::optional<double> maxFramerate;
+
+		absl::optional<double> scaleResolutionDownBy;
+
+		// "L1T3", "L3T3_KEY", ...
+		absl::optional<std::string> scalabilityMode;
+
+		// Full, half and quarter resolution at 900, 300 and 100 kbps
+		static std::vector<VideoLayer> defaultSimulcast()
+		{
+			std::vector<VideoLayer> layers(3);
+			layers[0].rid = "h";
+			layers[0].maxBitrateBps = 900000;
+
+			layers[1].rid = "m";
+			layers[1].maxBitrateBps = 300000;
+			layers[1].scaleResolutionDownBy = 2;
+
+			layers[2].rid = "l";
+			layers[2].maxBitrateBps = 100000;
+			layers[2].scaleResolutionDownBy = 4;
+			return layers;
+		}
+	};
+}
@@ -11,6 +11,37 @@
 #include "plugin_client.h"
 
 namespace vi {
+	namespace {
+		// Names the mid and the members a "configure" sets, a later configure with the same key
+		// supersedes it completely.
+		class ConfigureKey {
+		public:
+			explicit ConfigureKey(const absl::optional<std::string>& mid) : _key("configure:" + mid.value_or("")) {}
+
+			template <typename T>
+			ConfigureKey& add(const char* name, const absl::optional<T>& value)
+			{
+				if (value) {
+					_key.append(":").append(name);
+				}
+				return *this;
+			}
+
+			const std::string& str() const { return _key; }
+
+		private:
+			std::string _key;
+		};
+
+		// failures reach the callback as a null response
+		template <typename Response>
+		void notifyFailure(const std::function<void(std::shared_ptr<Response>)>& callback)
+		{
+			if (callback) {
+				callback(nullptr);
+			}
+		}
+	}
 
 	VideoRoomApi::VideoRoomApi(std::shared_ptr<PluginClient> pluginClient)
 		: _pluginClient(pluginClient)
@@ -28,12 +59,14 @@ namespace vi {
 		auto pluginClient = _pluginClient.lock();
 		if (!pluginClient) {
 			DLOG("invalid plugin client");
+			notifyFailure(callback);
 			return;
 		}
 		std::shared_ptr<MessageEvent> event = std::make_shared<vi::MessageEvent>();
 		auto lambda = [callback](bool success, const std::string& response) {
 			DLOG("response: {}", response.c_str());
 			if (response.empty()) {
+				notifyFailure(callback);
 				return;
 			}
 
@@ -43,6 +76,7 @@ namespace vi {
 
 			if (!err.empty()) {
 				DLOG("parse JanusResponse failed");
+				notifyFailure(callback);
 				return;
 			}
 
@@ -61,6 +95,7 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
 		curd(json, callback);
@@ -71,6 +106,7 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
 		curd(json, callback);
@@ -81,6 +117,7 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
 		curd(json, callback);
@@ -91,22 +128,25 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
 		curd(json, callback);
 	}
 
-	void VideoRoomApi::action(const std::string& request, std::function<void(std::shared_ptr<JanusResponse>)> callback)
+	void VideoRoomApi::action(const std::string& request, std::function<void(std::shared_ptr<JanusResponse>)> callback, const std::string& coalesceKey)
 	{
 		auto pluginClient = _pluginClient.lock();
 		if (!pluginClient) {
 			DLOG("invalid plugin client");
+			notifyFailure(callback);
 			return;
 		}
 		std::shared_ptr<MessageEvent> event = std::make_shared<vi::MessageEvent>();
 		auto lambda = [callback](bool success, const std::string& response) {
 			DLOG("response: {}", response.c_str());
 			if (response.empty()) {
+				notifyFailure(callback);
 				return;
 			}
 
@@ -116,6 +156,7 @@ namespace vi {
 
 			if (!err.empty()) {
 				DLOG("parse JanusResponse failed");
+				notifyFailure(callback);
 				return;
 			}
 
@@ -125,6 +166,7 @@ namespace vi {
 		};
 		std::shared_ptr<vi::EventCallback> cb = std::make_shared<vi::EventCallback>(lambda);
 		event->message = request;
+		event->coalesceKey = coalesceKey;
 		event->callback = cb;
 		pluginClient->sendMessage(event);
 	}
@@ -134,6 +176,7 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
 		action(json, callback);
@@ -144,6 +187,7 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
 		action(json, callback);
@@ -154,9 +198,24 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
-		action(json, callback);
+		// a keyframe request is one-shot, nothing may swallow it
+		std::string key;
+		if (!request->keyframe.value_or(false)) {
+			key = ConfigureKey(request->mid)
+				.add("bitrate", request->bitrate)
+				.add("record", request->record)
+				.add("filename", request->filename)
+				.add("display", request->display)
+				.add("audio_level_average", request->audio_level_average)
+				.add("audio_active_packets", request->audio_active_packets)
+				.add("send", request->send)
+				.add("descriptions", request->descriptions)
+				.str();
+		}
+		action(json, callback, key);
 	}
 
 	void VideoRoomApi::subscriberConfigure(std::shared_ptr<vr::SubscriberConfigureRequest> request, std::function<void(std::shared_ptr<JanusResponse>)> callback)
@@ -164,9 +223,24 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
-		action(json, callback);
+		// an ICE restart is one-shot, nothing may swallow it
+		std::string key;
+		if (!request->restart.value_or(false)) {
+			key = ConfigureKey(request->mid)
+				.add("send", request->send)
+				.add("substream", request->substream)
+				.add("temporal", request->temporal)
+				.add("fallback", request->fallback)
+				.add("spatial_layer", request->spatial_layer)
+				.add("temporal_layer", request->temporal_layer)
+				.add("audio_level_average", request->audio_level_average)
+				.add("audio_active_packets", request->audio_active_packets)
+				.str();
+		}
+		action(json, callback, key);
 	}
 
 	void VideoRoomApi::publish(std::shared_ptr<vr::PublishRequest> request, std::function<void(std::shared_ptr<JanusResponse>)> callback)
@@ -174,6 +248,7 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
 		action(json, callback);
@@ -184,6 +259,7 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
 		action(json, callback);
@@ -194,6 +270,7 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
 		action(json, callback);
@@ -204,6 +281,7 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
 		action(json, callback);
@@ -214,6 +292,7 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
 		action(json, callback);
@@ -224,6 +303,7 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
 		action(json, callback);
@@ -234,6 +314,7 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
 		action(json, callback);
@@ -244,6 +325,7 @@ namespace vi {
 		std::string json = request->toJsonStr();
 		if (json.empty()) {
 			DLOG("empty json string");
+			notifyFailure(callback);
 			return;
 		}
 		action(json, callback);
@@ -254,12 +336,14 @@ namespace vi {
 		auto pluginClient = _pluginClient.lock();
 		if (!pluginClient) {
 			DLOG("invalid plugin client");
+			notifyFailure(callback);
 			return;
 		}
 		std::shared_ptr<MessageEvent> event = std::make_shared<vi::MessageEvent>();
 		auto lambda = [callback](bool success, const std::string& response) {
 			DLOG("response: {}", response.c_str());
 			if (response.empty()) {
+				notifyFailure(callback);
 				return;
 			}
 
@@ -269,6 +353,7 @@ namespace vi {
 
 			if (!err.empty()) {
 				DLOG("parse AllowedResponse failed");
+				notifyFailure(callback);
 				return;
 			}
 
@@ -287,12 +372,14 @@ namespace vi {
 		auto pluginClient = _pluginClient.lock();
 		if (!pluginClient) {
 			DLOG("invalid plugin client");
+			notifyFailure(callback);
 			return;
 		}
 		std::shared_ptr<MessageEvent> event = std::make_shared<vi::MessageEvent>();
 		auto lambda = [callback](bool success, const std::string& response) {
 			DLOG("response: {}", response.c_str());
 			if (response.empty()) {
+				notifyFailure(callback);
 				return;
 			}
 
@@ -302,6 +389,7 @@ namespace vi {
 
 			if (!err.empty()) {
 				DLOG("parse KickResponse failed");
+				notifyFailure(callback);
 				return;
 			}
 
@@ -320,12 +408,14 @@ namespace vi {
 		auto pluginClient = _pluginClient.lock();
 		if (!pluginClient) {
 			DLOG("invalid plugin client");
+			notifyFailure(callback);
 			return;
 		}
 		std::shared_ptr<MessageEvent> event = std::make_shared<vi::MessageEvent>();
 		auto lambda = [callback](bool success, const std::string& response) {
 			DLOG("response: {}", response.c_str());
 			if (response.empty()) {
+				notifyFailure(callback);
 				return;
 			}
 
@@ -335,6 +425,7 @@ namespace vi {
 
 			if (!err.empty()) {
 				DLOG("parse ModerateResponse failed");
+				notifyFailure(callback);
 				return;
 			}
 
@@ -354,12 +445,14 @@ namespace vi {
 		auto pluginClient = _pluginClient.lock();
 		if (!pluginClient) {
 			DLOG("invalid plugin client");
+			notifyFailure(callback);
 			return;
 		}
 		std::shared_ptr<MessageEvent> event = std::make_shared<vi::MessageEvent>();
 		auto lambda = [callback](bool success, const std::string& response) {
 			DLOG("response: {}", response.c_str());
 			if (response.empty()) {
+				notifyFailure(callback);
 				return;
 			}
 
@@ -369,6 +462,7 @@ namespace vi {
 
 			if (!err.empty()) {
 				DLOG("parse FetchRoomsListResponse failed");
+				notifyFailure(callback);
 				return;
 			}
 
@@ -387,12 +481,14 @@ namespace vi {
 		auto pluginClient = _pluginClient.lock();
 		if (!pluginClient) {
 			DLOG("invalid plugin client");
+			notifyFailure(callback);
 			return;
 		}
 		std::shared_ptr<MessageEvent> event = std::make_shared<vi::MessageEvent>();
 		auto lambda = [callback](bool success, const std::string& response) {
 			DLOG("response: {}", response.c_str());
 			if (response.empty()) {
+				notifyFailure(callback);
 				return;
 			}
 
@@ -402,6 +498,7 @@ namespace vi {
 
 			if (!err.empty()) {
 				DLOG("parse FetchParticipantsResponse failed");
+				notifyFailure(callback);
 				return;
 			}
 
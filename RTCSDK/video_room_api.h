@@ -65,7 +65,8 @@ namespace vi {
 	private:
 		void curd(const std::string& request, std::function<void(std::shared_ptr<vr::RoomCurdResponse>)> callback);
 
-		void action(const std::string& request, std::function<void(std::shared_ptr<JanusResponse>)> callback);
+		// |coalesceKey| lets the request replace a still queued one with the same key, see MessageEvent
+		void action(const std::string& request, std::function<void(std::shared_ptr<JanusResponse>)> callback, const std::string& coalesceKey = "");
 
 	private:
 		std::weak_ptr<PluginClient> _pluginClient;
@@ -0,0 +1,150 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-12-9
+ **/
+
+#include "video_room_api_async.h"
+
+namespace vi {
+	namespace {
+		template <typename Response, typename Request, typename Method>
+		ProxyFuture<std::shared_ptr<Response>> send(IVideoRoomApi* api, Method method, std::shared_ptr<Request> request)
+		{
+			ProxyFuture<std::shared_ptr<Response>> future;
+			(api->*method)(request, [future](std::shared_ptr<Response> response) mutable {
+				if (!response) {
+					future.fail(ProxyError{ 0, "no response" });
+				}
+				else if (response->janus.value_or("") == "error") {
+					// also the timeouts (408) and rejections (503) the transport answers in place of Janus
+					ProxyError error;
+					if (response->error) {
+						error.code = response->error->code.value_or(0);
+						error.reason = response->error->reason.value_or("");
+					}
+					future.fail(std::move(error));
+				}
+				else {
+					future.set(std::move(response));
+				}
+			});
+			return future;
+		}
+
+		template <typename Response, typename Request>
+		using Method = void (IVideoRoomApi::*)(std::shared_ptr<Request>, std::function<void(std::shared_ptr<Response>)>);
+	}
+
+	AsyncVideoRoomApi::AsyncVideoRoomApi(std::shared_ptr<IVideoRoomApi> api)
+		: _api(api)
+	{
+
+	}
+
+	AsyncVideoRoomApi::Future<vr::RoomCurdResponse> AsyncVideoRoomApi::create(std::shared_ptr<vr::CreateRoomRequest> request)
+	{
+		return send<vr::RoomCurdResponse>(_api.get(), Method<vr::RoomCurdResponse, vr::CreateRoomRequest>(&IVideoRoomApi::create), request);
+	}
+
+	AsyncVideoRoomApi::Future<vr::RoomCurdResponse> AsyncVideoRoomApi::destroy(std::shared_ptr<vr::DestroyRoomRequest> request)
+	{
+		return send<vr::RoomCurdResponse>(_api.get(), Method<vr::RoomCurdResponse, vr::DestroyRoomRequest>(&IVideoRoomApi::destroy), request);
+	}
+
+	AsyncVideoRoomApi::Future<vr::RoomCurdResponse> AsyncVideoRoomApi::edit(std::shared_ptr<vr::EditRoomRequest> request)
+	{
+		return send<vr::RoomCurdResponse>(_api.get(), Method<vr::RoomCurdResponse, vr::EditRoomRequest>(&IVideoRoomApi::edit), request);
+	}
+
+	AsyncVideoRoomApi::Future<vr::RoomCurdResponse> AsyncVideoRoomApi::exists(std::shared_ptr<vr::ExistsRequest> request)
+	{
+		return send<vr::RoomCurdResponse>(_api.get(), Method<vr::RoomCurdResponse, vr::ExistsRequest>(&IVideoRoomApi::exists), request);
+	}
+
+	AsyncVideoRoomApi::Future<JanusResponse> AsyncVideoRoomApi::join(std::shared_ptr<vr::PublisherJoinRequest> request)
+	{
+		return send<JanusResponse>(_api.get(), Method<JanusResponse, vr::PublisherJoinRequest>(&IVideoRoomApi::join), request);
+	}
+
+	AsyncVideoRoomApi::Future<JanusResponse> AsyncVideoRoomApi::join(std::shared_ptr<vr::SubscriberJoinRequest> request)
+	{
+		return send<JanusResponse>(_api.get(), Method<JanusResponse, vr::SubscriberJoinRequest>(&IVideoRoomApi::join), request);
+	}
+
+	AsyncVideoRoomApi::Future<JanusResponse> AsyncVideoRoomApi::publisherConfigure(std::shared_ptr<vr::PublisherConfigureRequest> request)
+	{
+		return send<JanusResponse>(_api.get(), Method<JanusResponse, vr::PublisherConfigureRequest>(&IVideoRoomApi::publisherConfigure), request);
+	}
+
+	AsyncVideoRoomApi::Future<JanusResponse> AsyncVideoRoomApi::subscriberConfigure(std::shared_ptr<vr::SubscriberConfigureRequest> request)
+	{
+		return send<JanusResponse>(_api.get(), Method<JanusResponse, vr::SubscriberConfigureRequest>(&IVideoRoomApi::subscriberConfigure), request);
+	}
+
+	AsyncVideoRoomApi::Future<JanusResponse> AsyncVideoRoomApi::publish(std::shared_ptr<vr::PublishRequest> request)
+	{
+		return send<JanusResponse>(_api.get(), Method<JanusResponse, vr::PublishRequest>(&IVideoRoomApi::publish), request);
+	}
+
+	AsyncVideoRoomApi::Future<JanusResponse> AsyncVideoRoomApi::unpublish(std::shared_ptr<vr::UnpublishRequest> request)
+	{
+		return send<JanusResponse>(_api.get(), Method<JanusResponse, vr::UnpublishRequest>(&IVideoRoomApi::unpublish), request);
+	}
+
+	AsyncVideoRoomApi::Future<JanusResponse> AsyncVideoRoomApi::subscribe(std::shared_ptr<vr::SubscribeRequest> request)
+	{
+		return send<JanusResponse>(_api.get(), Method<JanusResponse, vr::SubscribeRequest>(&IVideoRoomApi::subscribe), request);
+	}
+
+	AsyncVideoRoomApi::Future<JanusResponse> AsyncVideoRoomApi::unsubscribe(std::shared_ptr<vr::UnsubscribeRequest> request)
+	{
+		return send<JanusResponse>(_api.get(), Method<JanusResponse, vr::UnsubscribeRequest>(&IVideoRoomApi::unsubscribe), request);
+	}
+
+	AsyncVideoRoomApi::Future<JanusResponse> AsyncVideoRoomApi::startPeerConnection(std::shared_ptr<vr::StartPeerConnectionRequest> request)
+	{
+		return send<JanusResponse>(_api.get(), Method<JanusResponse, vr::StartPeerConnectionRequest>(&IVideoRoomApi::startPeerConnection), request);
+	}
+
+	AsyncVideoRoomApi::Future<JanusResponse> AsyncVideoRoomApi::pausePeerConnection(std::shared_ptr<vr::PausePeerConnectionRequest> request)
+	{
+		return send<JanusResponse>(_api.get(), Method<JanusResponse, vr::PausePeerConnectionRequest>(&IVideoRoomApi::pausePeerConnection), request);
+	}
+
+	AsyncVideoRoomApi::Future<JanusResponse> AsyncVideoRoomApi::switchPublisher(std::shared_ptr<vr::SwitchPublisherRequest> request)
+	{
+		return send<JanusResponse>(_api.get(), Method<JanusResponse, vr::SwitchPublisherRequest>(&IVideoRoomApi::switchPublisher), request);
+	}
+
+	AsyncVideoRoomApi::Future<JanusResponse> AsyncVideoRoomApi::leave(std::shared_ptr<vr::LeaveRequest> request)
+	{
+		return send<JanusResponse>(_api.get(), Method<JanusResponse, vr::LeaveRequest>(&IVideoRoomApi::leave), request);
+	}
+
+	AsyncVideoRoomApi::Future<vr::AllowedResponse> AsyncVideoRoomApi::allowed(std::shared_ptr<vr::AllowedRequest> request)
+	{
+		return send<vr::AllowedResponse>(_api.get(), Method<vr::AllowedResponse, vr::AllowedRequest>(&IVideoRoomApi::allowed), request);
+	}
+
+	AsyncVideoRoomApi::Future<vr::KickResponse> AsyncVideoRoomApi::kick(std::shared_ptr<vr::KickRequest> request)
+	{
+		return send<vr::KickResponse>(_api.get(), Method<vr::KickResponse, vr::KickRequest>(&IVideoRoomApi::kick), request);
+	}
+
+	AsyncVideoRoomApi::Future<vr::ModerateResponse> AsyncVideoRoomApi::moderate(std::shared_ptr<vr::ModerateRequest> request)
+	{
+		return send<vr::ModerateResponse>(_api.get(), Method<vr::ModerateResponse, vr::ModerateRequest>(&IVideoRoomApi::moderate), request);
+	}
+
+	AsyncVideoRoomApi::Future<vr::FetchRoomsListResponse> AsyncVideoRoomApi::fetchRoomsList(std::shared_ptr<vr::FetchRoomsListRequest> request)
+	{
+		return send<vr::FetchRoomsListResponse>(_api.get(), Method<vr::FetchRoomsListResponse, vr::FetchRoomsListRequest>(&IVideoRoomApi::fetchRoomsList), request);
+	}
+
+	AsyncVideoRoomApi::Future<vr::FetchParticipantsResponse> AsyncVideoRoomApi::fetchParticipants(std::shared_ptr<vr::FetchParticipantsRequest> request)
+	{
+		return send<vr::FetchParticipantsResponse>(_api.get(), Method<vr::FetchParticipantsResponse, vr::FetchParticipantsRequest>(&IVideoRoomApi::fetchParticipants), request);
+	}
+
+}
@@ -0,0 +1,74 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-12-9
+ **/
+
+#pragma once
+
+#include <memory>
+#include "i_video_room_api.h"
+#include "proxy_future.h"
+
+namespace vi {
+
+	// Future based face of IVideoRoomApi. A call sends its request at once and returns, so requests
+	// that don't depend on each other are in flight together; combine them with whenAll(). Call it
+	// in plugin-client thread, the futures then resume there (by then() or co_await).
+	// A future fails if the request could not be sent, Janus answered with an error or the request
+	// timed out; plugin level errors (error_code in plugindata) are part of the response.
+	class AsyncVideoRoomApi
+	{
+	public:
+		template <typename T>
+		using Future = ProxyFuture<std::shared_ptr<T>>;
+
+		explicit AsyncVideoRoomApi(std::shared_ptr<IVideoRoomApi> api);
+
+		Future<vr::RoomCurdResponse> create(std::shared_ptr<vr::CreateRoomRequest> request);
+
+		Future<vr::RoomCurdResponse> destroy(std::shared_ptr<vr::DestroyRoomRequest> request);
+
+		Future<vr::RoomCurdResponse> edit(std::shared_ptr<vr::EditRoomRequest> request);
+
+		Future<vr::RoomCurdResponse> exists(std::shared_ptr<vr::ExistsRequest> request);
+
+		Future<JanusResponse> join(std::shared_ptr<vr::PublisherJoinRequest> request);
+
+		Future<JanusResponse> join(std::shared_ptr<vr::SubscriberJoinRequest> request);
+
+		Future<JanusResponse> publisherConfigure(std::shared_ptr<vr::PublisherConfigureRequest> request);
+
+		Future<JanusResponse> subscriberConfigure(std::shared_ptr<vr::SubscriberConfigureRequest> request);
+
+		Future<JanusResponse> publish(std::shared_ptr<vr::PublishRequest> request);
+
+		Future<JanusResponse> unpublish(std::shared_ptr<vr::UnpublishRequest> request);
+
+		Future<JanusResponse> subscribe(std::shared_ptr<vr::SubscribeRequest> request);
+
+		Future<JanusResponse> unsubscribe(std::shared_ptr<vr::UnsubscribeRequest> request);
+
+		Future<JanusResponse> startPeerConnection(std::shared_ptr<vr::StartPeerConnectionRequest> request);
+
+		Future<JanusResponse> pausePeerConnection(std::shared_ptr<vr::PausePeerConnectionRequest> request);
+
+		Future<JanusResponse> switchPublisher(std::shared_ptr<vr::SwitchPublisherRequest> request);
+
+		Future<JanusResponse> leave(std::shared_ptr<vr::LeaveRequest> request);
+
+		Future<vr::AllowedResponse> allowed(std::shared_ptr<vr::AllowedRequest> request);
+
+		Future<vr::KickResponse> kick(std::shared_ptr<vr::KickRequest> request);
+
+		Future<vr::ModerateResponse> moderate(std::shared_ptr<vr::ModerateRequest> request);
+
+		Future<vr::FetchRoomsListResponse> fetchRoomsList(std::shared_ptr<vr::FetchRoomsListRequest> request);
+
+		Future<vr::FetchParticipantsResponse> fetchParticipants(std::shared_ptr<vr::FetchParticipantsRequest> request);
+
+	private:
+		std::shared_ptr<IVideoRoomApi> _api;
+	};
+
+}
@@ -15,11 +15,18 @@
 #include "pc/media_stream_proxy.h"
 #include "pc/media_stream_track_proxy.h"
 #include "media_controller.h"
+#include "janus_message.h"
 #include "participants_controller.h"
+#include "teardown_coordinator.h"
 
 namespace vi {
-	VideoRoomClient::VideoRoomClient(std::shared_ptr<SignalingClientInterface> sc, rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> pcf)
-		: PluginClient(sc, pcf)
+	namespace {
+		// the detach requests are not waited for longer
+		const uint32_t kDetachDeadlineMs = 3000;
+	}
+
+	VideoRoomClient::VideoRoomClient(std::shared_ptr<ThreadProvider> threads, std::shared_ptr<SignalingClientInterface> sc, rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> pcf)
+		: PluginClient(threads, sc, pcf)
 	{
 		_pluginContext->plugin = "janus.plugin.videoroom";
 		_pluginContext->opaqueId = "videoroom-" + StringUtils::randomString(12);
@@ -36,13 +43,13 @@ namespace vi {
 
 		_videoRoomApi = std::make_shared<VideoRoomApi>(shared_from_this());
 
-		_mediaController = std::make_shared<MediaController>(std::dynamic_pointer_cast<VideoRoomClient>(PluginClient::shared_from_this()));
-		_mediaControllerProxy = MediaControllerProxy::Create(TMgr->thread("plugin-client"), _mediaController);
+		_mediaController = std::make_shared<MediaController>(std::dynamic_pointer_cast<VideoRoomClient>(PluginClient::shared_from_this()), _threads->thread("main"));
+		_mediaControllerProxy = MediaControllerProxy::Create(_pluginThread, _mediaController);
 
-		_participantsController = std::make_shared<ParticipantsContrller>();
-		_participantsControllerProxy = ParticipantsContrllerProxy::Create(TMgr->thread("plugin-client"), _participantsController);
+		_participantsController = std::make_shared<ParticipantsContrller>(_threads->thread("main"));
+		_participantsControllerProxy = ParticipantsContrllerProxy::Create(_pluginThread, _participantsController);
 
-		_subscriber = std::make_shared<VideoRoomSubscriber>(_pluginContext->signalingClient.lock(), _pluginContext->pcf, _pluginContext->plugin, _pluginContext->opaqueId, _mediaController, _videoRoomApi);
+		_subscriber = std::make_shared<VideoRoomSubscriber>(_threads, _pluginContext->signalingClient.lock(), _pluginContext->pcf, _pluginContext->plugin, _pluginContext->opaqueId, _mediaController, _videoRoomApi);
 		_subscriber->init();
 	}
 
@@ -53,7 +60,7 @@ namespace vi {
 
 	void VideoRoomClient::registerEventHandler(std::shared_ptr<IVideoRoomEventHandler> handler)
 	{
-		UniversalObservable<IVideoRoomEventHandler>::addWeakObserver(handler, std::string("main"));
+		UniversalObservable<IVideoRoomEventHandler>::addWeakObserver(handler, _threads->thread("main"));
 
 		_subscriber->registerEventHandler(handler);
 	}
@@ -72,16 +79,22 @@ namespace vi {
 
 	void VideoRoomClient::detach()
 	{
+		_joinRequest = nullptr;
+		_rejoinPending = false;
+
+		// publisher and subscriber go down together, see TeardownCoordinator
 		auto event = std::make_shared<DetachEvent>();
+		event->teardown = TeardownCoordinator::create(_pluginThread, _threads->closePool(), kDetachDeadlineMs, nullptr);
 		PluginClient::detach(event);
 		_subscriber->detach(event);
+		event->teardown->start();
 	}
 
 	void VideoRoomClient::create(std::shared_ptr<vr::CreateRoomRequest> request)
 	{
 		if (_videoRoomApi) {
 			_videoRoomApi->create(request, [this, request](std::shared_ptr<vr::RoomCurdResponse> response) {
-				if (response->janus == "success") {
+				if (response && response->janus == "success") {
 					UniversalObservable<IVideoRoomEventHandler>::notifyObservers([request, response](const auto& observer) {
 						if (response->plugindata->data.videoroom.value_or("") == "created") {
 							auto result = std::make_shared<CreateRoomResult>();
@@ -109,12 +122,13 @@ namespace vi {
 	void VideoRoomClient::join(std::shared_ptr<vr::PublisherJoinRequest> request)
 	{
 		_roomId = request->room.value();
+		_joinRequest = request;
 
 		_subscriber->setRoomId(_roomId);
 
 		if (_videoRoomApi) {
 			_videoRoomApi->join(request, [this](std::shared_ptr<JanusResponse> response) {
-				if (response->janus == "ack") {
+				if (response && response->janus == "ack") {
 					UniversalObservable<IVideoRoomEventHandler>::notifyObservers([roomId = _roomId](const auto& observer) {
 						observer->onJoinRoom(roomId, 0);
 					});
@@ -131,9 +145,12 @@ namespace vi {
 
 	void VideoRoomClient::leave(std::shared_ptr<vr::LeaveRequest> request)
 	{
+		_joinRequest = nullptr;
+		_rejoinPending = false;
+
 		if (_videoRoomApi) {
 			_videoRoomApi->leave(request, [this](std::shared_ptr<JanusResponse> response) {
-				if (response->janus == "ack") {
+				if (response && response->janus == "ack") {
 					UniversalObservable<IVideoRoomEventHandler>::notifyObservers([roomId = _roomId](const auto& observer) {
 						observer->onLeaveRoom(roomId, 0);
 					});
@@ -163,8 +180,14 @@ namespace vi {
 		if (success) {
 			DLOG("Plugin attached! ({}, id = {})", _pluginContext->plugin.c_str(), _id);
 			DLOG("  -- This is a publisher/manager");
+			if (_rejoinPending && _joinRequest) {
+				_rejoinPending = false;
+				// the subscriber follows with the publishers listed in "joined"
+				join(_joinRequest);
+			}
 		}
 		else {
+			_rejoinPending = false;
 			ELOG("  -- Error attaching plugin...");
 		}
 	}
@@ -194,14 +217,25 @@ namespace vi {
 
 	void VideoRoomClient::onSlowLink(bool uplink, bool lost, const std::string& mid) {}
 
-	void VideoRoomClient::onMessage(const std::string& data, const std::string& jsepString)
+	void VideoRoomClient::decode(std::shared_ptr<const JanusMessage> message) const
+	{
+		PluginClient::decode(message);
+
+		auto vrEvent = message->view<vr::VideoRoomEvent>();
+		if (vrEvent && vrEvent->plugindata && vrEvent->plugindata->data) {
+			if (vrEvent->plugindata->data->videoroom.value_or("") == "joined") {
+				message->view<vr::PublisherJoinEvent>();
+			}
+		}
+	}
+
+	void VideoRoomClient::onMessage(std::shared_ptr<const JanusMessage> message)
 	{
 		DLOG(" ::: Got a message (publisher).");
 
-		std::string err;
-		std::shared_ptr<vr::VideoRoomEvent> vrEvent = fromJsonString<vr::VideoRoomEvent>(data, err);
-		if (!err.empty()) {
-			DLOG("parse JanusResponse failed");
+		auto vrEvent = message->view<vr::VideoRoomEvent>();
+		if (!vrEvent || !vrEvent->plugindata || !vrEvent->plugindata->data) {
+			DLOG("parse VideoRoomEvent failed");
 			return;
 		}
 
@@ -222,10 +256,9 @@ namespace vi {
 		const auto& event = pluginData->data->videoroom;
 
 		if (event.value_or("") == "joined") {
-			std::string err;
-			std::shared_ptr<vr::PublisherJoinEvent> pjEvent = fromJsonString<vr::PublisherJoinEvent>(data, err);
-			if (!err.empty()) {
-				DLOG("parse JanusResponse failed");
+			auto pjEvent = message->view<vr::PublisherJoinEvent>();
+			if (!pjEvent || !pjEvent->plugindata || !pjEvent->plugindata->data) {
+				DLOG("parse PublisherJoinEvent failed");
 				return;
 			}
 
@@ -274,7 +307,7 @@ namespace vi {
 				// Figure out the participant and detach it
 				removeParticipant(leaving);
 
-				//_subscriber->unsubscribeFrom(leaving);
+				_subscriber->onPublisherLeft(leaving);
 			}
 			else if (pluginData->data->unpublished) {
 				const auto& unpublished = pluginData->data->unpublished.value();
@@ -290,7 +323,7 @@ namespace vi {
 				// Figure out the participant and detach it
 				removeParticipant(unpublished);
 
-				//_subscriber->unsubscribeFrom(unpublished);
+				_subscriber->onPublisherLeft(unpublished);
 			}
 			else if (pluginData->data->error) {
 				if (pluginData->data->error_code.value_or(0) == 426) {
@@ -299,13 +332,8 @@ namespace vi {
 			}
 		}
 
-		if (jsepString.empty()) {
-			return;
-		}
-		err.clear();
-		std::shared_ptr<Jsep> jsep = fromJsonString<Jsep>(jsepString, err);
-		if (!err.empty()) {
-			DLOG("parse JanusResponse failed");
+		auto jsep = message->view<Jsep>("jsep");
+		if (!jsep) {
 			return;
 		}
 
@@ -356,12 +384,21 @@ namespace vi {
 		_mediaController->onLocalTrack(track, _id, on);
 	}
 
-	void VideoRoomClient::onCleanup()
+	void VideoRoomClient::onCleanup(std::shared_ptr<TeardownCoordinator> teardown)
 	{
-		PluginClient::onCleanup();
+		PluginClient::onCleanup(teardown);
 	}
 
-	void VideoRoomClient::onDetached() {}
+	void VideoRoomClient::onDetached()
+	{
+		if (!_joinRequest) {
+			return;
+		}
+		// the handle is gone while we are in a room, attach again and join it once more
+		WLOG("publisher handle lost, joining room {} again", _roomId);
+		_rejoinPending = true;
+		attach();
+	}
 
 	void VideoRoomClient::publishStream(bool audioOn)
 	{
@@ -395,9 +432,8 @@ namespace vi {
 		media.videoRecv = false;
 		media.audioSend = audioOn;
 		media.videoSend = true;
+		media.videoLayers = VideoLayer::defaultSimulcast();
 		event->media = media;
-		event->simulcast = true;
-		event->simulcast2 = false;
 		createOffer(event);
 	}
 
@@ -28,7 +28,7 @@ namespace vi {
 	class VideoRoomClient : public PluginClient, public VideoRoomClientInterface, public UniversalObservable<IVideoRoomEventHandler>
 	{
 	public:
-		VideoRoomClient(std::shared_ptr<SignalingClientInterface> sc, rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> pcf);
+		VideoRoomClient(std::shared_ptr<ThreadProvider> threads, std::shared_ptr<SignalingClientInterface> sc, rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> pcf);
 
 		~VideoRoomClient();
 
@@ -58,6 +58,8 @@ namespace vi {
 
 		std::shared_ptr<IVideoRoomApi> videoRoomApi() { return _videoRoomApi; }
 
+		std::shared_ptr<VideoRoomSubscriber> subscriber() { return _subscriber; }
+
 	protected:
 
 		// signaling events
@@ -70,7 +72,9 @@ namespace vi {
 
 		void onSlowLink(bool uplink, bool lost, const std::string& mid) override;
 
-		void onMessage(const std::string& data, const std::string& jsep) override;
+		void onMessage(std::shared_ptr<const JanusMessage> message) override;
+
+		void decode(std::shared_ptr<const JanusMessage> message) const override;
 
 		void onTimeout()override;
 
@@ -78,7 +82,7 @@ namespace vi {
 
 		void onHangup() override;
 
-		void onCleanup() override;
+		void onCleanup(std::shared_ptr<TeardownCoordinator> teardown) override;
 
 		void onDetached() override;
 
@@ -102,6 +106,11 @@ namespace vi {
 	private:
 		std::string _roomId;
 
+		// the room to join again when the handle is lost, e.g. with an expired session. Reset by leave() and detach().
+		std::shared_ptr<vr::PublisherJoinRequest> _joinRequest;
+
+		bool _rejoinPending = false;
+
 		std::shared_ptr<IVideoRoomApi> _videoRoomApi;
 
 		std::shared_ptr<VideoRoomSubscriber> _subscriber;
@@ -42,15 +42,15 @@ namespace vi {
 
 	BEGIN_WEAK_PROXY_MAP(VideoRoomClient)
 		WEAK_PROXY_THREAD_DESTRUCTOR()
-		WEAK_PROXY_METHOD0(void, init)
-		WEAK_PROXY_METHOD0(void, destroy)
-		WEAK_PROXY_METHOD1(void, registerEventHandler, std::shared_ptr<IVideoRoomEventHandler>)
-		WEAK_PROXY_METHOD1(void, unregisterEventHandler, std::shared_ptr<IVideoRoomEventHandler>)
-		WEAK_PROXY_METHOD0(void, attach)
-		WEAK_PROXY_METHOD0(void, detach)
-		WEAK_PROXY_METHOD1(void, create, std::shared_ptr<vr::CreateRoomRequest>)
-		WEAK_PROXY_METHOD1(void, join, std::shared_ptr<vr::PublisherJoinRequest>)
-		WEAK_PROXY_METHOD1(void, leave, std::shared_ptr<vr::LeaveRequest>)
+		WEAK_PROXY_ASYNC_METHOD0(init)
+		WEAK_PROXY_ASYNC_METHOD0(destroy)
+		WEAK_PROXY_ASYNC_METHOD1(registerEventHandler, std::shared_ptr<IVideoRoomEventHandler>)
+		WEAK_PROXY_ASYNC_METHOD1(unregisterEventHandler, std::shared_ptr<IVideoRoomEventHandler>)
+		WEAK_PROXY_ASYNC_METHOD0(attach)
+		WEAK_PROXY_ASYNC_METHOD0(detach)
+		WEAK_PROXY_ASYNC_METHOD1(create, std::shared_ptr<vr::CreateRoomRequest>)
+		WEAK_PROXY_ASYNC_METHOD1(join, std::shared_ptr<vr::PublisherJoinRequest>)
+		WEAK_PROXY_ASYNC_METHOD1(leave, std::shared_ptr<vr::LeaveRequest>)
 		WEAK_PROXY_METHOD0(std::shared_ptr<ParticipantsContrllerInterface>, participantsController)
 		WEAK_PROXY_METHOD0(std::shared_ptr<MediaControllerInterface>, mediaContrller)
 	END_WEAK_PROXY_MAP()
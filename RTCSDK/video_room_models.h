@@ -472,6 +472,26 @@ namespace vi {
 			FIELDS_MAP("request", request, "streams", streams);
 		};
 
+		/*
+		 * Subscribing to some streams and unsubscribing from others at once, which takes a
+		 * single renegotiation:
+		 */
+		//\verbatim
+		/*{
+		 *	"request" : "update",
+		 *	"subscribe" : [ <streams to add, same format as in "subscribe"> ],
+		 *	"unsubscribe" : [ <streams to remove, same format as in "unsubscribe"> ]
+		 }*/
+		//\endverbatim
+
+		struct UpdateRequest {
+			absl::optional<std::string> request = "update";
+			absl::optional<std::vector<SubscribeRequest::Stream>> subscribe;
+			absl::optional<std::vector<UnsubscribeRequest::Stream>> unsubscribe;
+
+			FIELDS_MAP("request", request, "subscribe", subscribe, "unsubscribe", unsubscribe);
+		};
+
 		struct StartPeerConnectionRequest {
 			absl::optional<std::string> request = "start";
 			absl::optional<std::string> room;
@@ -593,8 +613,9 @@ namespace vi {
 			absl::optional<int64_t> session_id;
 			absl::optional<int64_t> sender;
 			absl::optional<RoomCurdPluginData> plugindata;
+			absl::optional<JanusError> error;
 
-			FIELDS_MAP("janus", janus, "transaction", transaction, "session_id", session_id, "sender", sender, "plugindata", plugindata);
+			FIELDS_MAP("janus", janus, "transaction", transaction, "session_id", session_id, "sender", sender, "plugindata", plugindata, "error", error);
 		};
 
 		/*
@@ -789,8 +810,9 @@ namespace vi {
 			absl::optional<int64_t> session_id;
 			absl::optional<int64_t> sender;
 			absl::optional<AllowedPluginData> plugindata;
+			absl::optional<JanusError> error;
 
-			FIELDS_MAP("janus", janus, "transaction", transaction, "session_id", session_id, "sender", sender, "plugindata", plugindata);
+			FIELDS_MAP("janus", janus, "transaction", transaction, "session_id", session_id, "sender", sender, "plugindata", plugindata, "error", error);
 		};
 
 		/*
@@ -842,8 +864,9 @@ namespace vi {
 			absl::optional<int64_t> session_id;
 			absl::optional<int64_t> sender;
 			absl::optional<KickPluginData> plugindata;
+			absl::optional<JanusError> error;
 
-			FIELDS_MAP("janus", janus, "transaction", transaction, "session_id", session_id, "sender", sender, "plugindata", plugindata);
+			FIELDS_MAP("janus", janus, "transaction", transaction, "session_id", session_id, "sender", sender, "plugindata", plugindata, "error", error);
 		};
 
 		/*   
@@ -901,8 +924,9 @@ namespace vi {
 			absl::optional<int64_t> session_id;
 			absl::optional<int64_t> sender;
 			absl::optional<ModeratePluginData> plugindata;
+			absl::optional<JanusError> error;
 
-			FIELDS_MAP("janus", janus, "transaction", transaction, "session_id", session_id, "sender", sender, "plugindata", plugindata);
+			FIELDS_MAP("janus", janus, "transaction", transaction, "session_id", session_id, "sender", sender, "plugindata", plugindata, "error", error);
 		};
 
 		/*
@@ -971,8 +995,9 @@ namespace vi {
 			absl::optional<int64_t> session_id;
 			absl::optional<int64_t> sender;
 			absl::optional<FetchRoomsListPluginData> plugindata;
+			absl::optional<JanusError> error;
 
-			FIELDS_MAP("janus", janus, "transaction", transaction, "session_id", session_id, "sender", sender, "plugindata", plugindata);
+			FIELDS_MAP("janus", janus, "transaction", transaction, "session_id", session_id, "sender", sender, "plugindata", plugindata, "error", error);
 		};
 
 		/*
@@ -1025,8 +1050,9 @@ namespace vi {
 			absl::optional<int64_t> session_id;
 			absl::optional<int64_t> sender;
 			absl::optional<ParticipantPluginData> plugindata;
+			absl::optional<JanusError> error;
 
-			FIELDS_MAP("janus", janus, "transaction", transaction, "session_id", session_id, "sender", sender, "plugindata", plugindata);
+			FIELDS_MAP("janus", janus, "transaction", transaction, "session_id", session_id, "sender", sender, "plugindata", plugindata, "error", error);
 		};
 
 		/*
@@ -9,16 +9,19 @@
 #include "pc/media_stream_proxy.h"
 #include "pc/media_stream_track_proxy.h"
 #include "media_controller.h"
+#include "janus_message.h"
+#include "subscription_quality_controller.h"
 
 namespace vi {
 
-	VideoRoomSubscriber::VideoRoomSubscriber(std::shared_ptr<SignalingClientInterface> sc, 
+	VideoRoomSubscriber::VideoRoomSubscriber(std::shared_ptr<ThreadProvider> threads,
+		std::shared_ptr<SignalingClientInterface> sc, 
 		rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> pcf,
 		const std::string& plugin,
 		const std::string& opaqueId, 
 		std::shared_ptr<MediaController> mc,
 		std::shared_ptr<IVideoRoomApi> api)
-		: PluginClient(sc, pcf)
+		: PluginClient(threads, sc, pcf)
 		, _mediaController(mc)
 		, _videoRoomApi(api)
 	{
@@ -35,11 +38,18 @@ namespace vi {
 	void VideoRoomSubscriber::init()
 	{
 		PluginClient::init();
+
+		_subscriberApi = std::make_shared<VideoRoomApi>(PluginClient::shared_from_this());
+		_qualityController = std::make_shared<SubscriptionQualityController>(_subscriberApi, _pluginThread);
+		_subscriptions = std::make_shared<SubscriptionManager>(_pluginThread, [wself = weak_from_this()](const std::vector<SubscriptionManager::Stream>& subscribe, const std::vector<SubscriptionManager::Stream>& unsubscribe) {
+			auto self = std::dynamic_pointer_cast<VideoRoomSubscriber>(wself.lock());
+			return self ? self->sendSubscriptionUpdate(subscribe, unsubscribe) : false;
+		});
 	}
 
 	void VideoRoomSubscriber::registerEventHandler(std::shared_ptr<IVideoRoomEventHandler> handler)
 	{
-		UniversalObservable<IVideoRoomEventHandler>::addWeakObserver(handler, std::string("main"));
+		UniversalObservable<IVideoRoomEventHandler>::addWeakObserver(handler, _threads->thread("main"));
 	}
 
 	void VideoRoomSubscriber::unregisterEventHandler(std::shared_ptr<IVideoRoomEventHandler> handler)
@@ -64,23 +74,57 @@ namespace vi {
 
 	void VideoRoomSubscriber::subscribeTo(const std::vector<vr::Publisher>& publishers)
 	{
-		if (_attached) {
-			subscribe(publishers);
+		for (const auto& pub : publishers) {
+			if (!pub.id) {
+				continue;
+			}
+			std::vector<std::string> mids;
+			if (pub.streams) {
+				for (const auto& str : pub.streams.value()) {
+					if (str.mid && !str.disabled.value_or(false)) {
+						mids.emplace_back(str.mid.value());
+					}
+				}
+			}
+			_subscriptions->set(pub.id.value(), mids);
 		}
-		else {
+
+		if (!_attachRequested) {
+			_attachRequested = true;
 			this->attach();
-			_joinTask = [wself = weak_from_this(), publishers]() {
-				auto self = wself.lock();
-				if (!self) {
-					return;
-				}
-				auto vrs = std::dynamic_pointer_cast<VideoRoomSubscriber>(self);
-				vrs->join(publishers);
-			};
 		}
 	}
 
-	void VideoRoomSubscriber::join(const std::vector<vr::Publisher>& publishers)
+	void VideoRoomSubscriber::unsubscribeFrom(int64_t id)
+	{
+		_subscriptions->remove(id);
+	}
+
+	void VideoRoomSubscriber::onPublisherLeft(int64_t id)
+	{
+		_subscriptions->forget(id);
+	}
+
+	bool VideoRoomSubscriber::sendSubscriptionUpdate(const std::vector<SubscriptionManager::Stream>& subscribe, const std::vector<SubscriptionManager::Stream>& unsubscribe)
+	{
+		if (!_handleAttached) {
+			return false;
+		}
+
+		if (!_joined) {
+			// the first streams go with the join, which creates the PeerConnection
+			if (subscribe.empty()) {
+				return false;
+			}
+			join(subscribe);
+		}
+		else {
+			update(subscribe, unsubscribe);
+		}
+		return true;
+	}
+
+	void VideoRoomSubscriber::join(const std::vector<SubscriptionManager::Stream>& streams)
 	{
 		vr::SubscriberJoinRequest request;
 
@@ -89,33 +133,24 @@ namespace vi {
 		request.ptype = "subscriber";
 		request.private_id = _privateId;
 
-		for (const auto& pub : publishers) {
-			if (pub.streams) {
-				auto ss = std::vector<vr::SubscriberJoinRequest::Stream>();
-				for (const auto& str : pub.streams.value()) {
-					vr::SubscriberJoinRequest::Stream stream;
-					stream.feed = pub.id;
-					stream.mid = str.mid;
-					ss.emplace_back(stream);
-				}
-				if (!ss.empty()) {
-					request.streams = ss;
-				}
-			}
+		auto ss = std::vector<vr::SubscriberJoinRequest::Stream>();
+		for (const auto& str : streams) {
+			vr::SubscriberJoinRequest::Stream stream;
+			stream.feed = str.feed;
+			stream.mid = str.mid;
+			ss.emplace_back(stream);
 		}
+		request.streams = ss;
 
 		std::shared_ptr<MessageEvent> event = std::make_shared<vi::MessageEvent>();
-		auto lambda = [](bool success, const std::string& response) {
+		auto lambda = [wself = weak_from_this()](bool success, const std::string& response) {
 			DLOG("response: {}", response.c_str());
-			if (response.empty()) {
+			// on success the answer comes as an event with an offer
+			if (success) {
 				return;
 			}
-
-			std::string err;
-			std::shared_ptr<JanusResponse> rar = fromJsonString<JanusResponse>(response, err);
-			if (!err.empty()) {
-				DLOG("parse JanusResponse failed");
-				return;
+			if (auto self = std::dynamic_pointer_cast<VideoRoomSubscriber>(wself.lock())) {
+				self->_subscriptions->acknowledge(false);
 			}
 		};
 		std::shared_ptr<vi::EventCallback> cb = std::make_shared<vi::EventCallback>(lambda);
@@ -125,39 +160,43 @@ namespace vi {
 		sendMessage(event);
 	}
 
-	void VideoRoomSubscriber::subscribe(const std::vector<vr::Publisher>& publishers)
+	void VideoRoomSubscriber::update(const std::vector<SubscriptionManager::Stream>& subscribe, const std::vector<SubscriptionManager::Stream>& unsubscribe)
 	{
-		vr::SubscribeRequest request;
+		vr::UpdateRequest request;
 
-		request.request = "subscribe";
+		request.request = "update";
 
-		for (const auto& pub : publishers) {
-			if (pub.streams) {
-				auto ss = std::vector<vr::SubscribeRequest::Stream>();
-				for (const auto& str : pub.streams.value()) {
-					vr::SubscribeRequest::Stream stream;
-					stream.feed = pub.id;
-					stream.mid = str.mid;
-					ss.emplace_back(stream);
-				}
-				if (!ss.empty()) {
-					request.streams = ss;
-				}
+		if (!subscribe.empty()) {
+			auto ss = std::vector<vr::SubscribeRequest::Stream>();
+			for (const auto& str : subscribe) {
+				vr::SubscribeRequest::Stream stream;
+				stream.feed = str.feed;
+				stream.mid = str.mid;
+				ss.emplace_back(stream);
+			}
+			request.subscribe = ss;
+		}
+
+		if (!unsubscribe.empty()) {
+			auto us = std::vector<vr::UnsubscribeRequest::Stream>();
+			for (const auto& str : unsubscribe) {
+				vr::UnsubscribeRequest::Stream stream;
+				stream.feed = str.feed;
+				stream.mid = str.mid;
+				us.emplace_back(stream);
 			}
+			request.unsubscribe = us;
 		}
 
 		std::shared_ptr<MessageEvent> event = std::make_shared<vi::MessageEvent>();
-		auto lambda = [](bool success, const std::string& response) {
+		auto lambda = [wself = weak_from_this()](bool success, const std::string& response) {
 			DLOG("response: {}", response.c_str());
-			if (response.empty()) {
+			// on success the answer comes as an event with an offer
+			if (success) {
 				return;
 			}
-
-			std::string err;
-			std::shared_ptr<JanusResponse> rar = fromJsonString<JanusResponse>(response, err);
-			if (!err.empty()) {
-				DLOG("parse JanusResponse failed");
-				return;
+			if (auto self = std::dynamic_pointer_cast<VideoRoomSubscriber>(wself.lock())) {
+				self->_subscriptions->acknowledge(false);
 			}
 		};
 		std::shared_ptr<vi::EventCallback> cb = std::make_shared<vi::EventCallback>(lambda);
@@ -166,46 +205,28 @@ namespace vi {
 		sendMessage(event);
 	}
 
-	void VideoRoomSubscriber::unsubscribeFrom(int64_t id)
+	void VideoRoomSubscriber::setViewSize(const std::string& mid, int width, int height)
 	{
-		vr::UnsubscribeRequest request;
-
-		request.request = "subscribe";
-
-		vr::UnsubscribeRequest::Stream stream;
-		stream.feed = id;
-		auto ss = std::vector<vr::UnsubscribeRequest::Stream>();
-		ss.emplace_back(stream);
-		request.streams = ss;
-
-		std::shared_ptr<MessageEvent> event = std::make_shared<vi::MessageEvent>();
-		auto lambda = [](bool success, const std::string& response) {
-			DLOG("response: {}", response.c_str());
-			if (response.empty()) {
-				return;
-			}
+		if (_qualityController) {
+			_qualityController->setViewSize(mid, width, height);
+		}
+	}
 
-			std::string err;
-			std::shared_ptr<JanusResponse> rar = fromJsonString<JanusResponse>(response, err);
-			if (!err.empty()) {
-				DLOG("parse JanusResponse failed");
-				return;
-			}
-		};
-		std::shared_ptr<vi::EventCallback> cb = std::make_shared<vi::EventCallback>(lambda);
-		event->message = request.toJsonStr();
-		event->callback = cb;
-		sendMessage(event);
+	void VideoRoomSubscriber::setViewVisible(const std::string& mid, bool visible)
+	{
+		if (_qualityController) {
+			_qualityController->setVisible(mid, visible);
+		}
 	}
 
 	void VideoRoomSubscriber::onAttached(bool success)
 	{
 		if (success) {
-			if (_joinTask) {
-				_joinTask();
-			}
+			_handleAttached = true;
+			_subscriptions->flush();
 		}
 		else {
+			_attachRequested = false;
 			DLOG("  -- Error attaching plugin...");
 		}
 	}
@@ -229,14 +250,25 @@ namespace vi {
 		DLOG("Janus reports problems {} packets on mid {} ({} lost packets)", (uplink ? "sending" : "receiving"), mid, lost);
 	}
 
-	void VideoRoomSubscriber::onMessage(const std::string& data, const std::string& jsepString)
+	void VideoRoomSubscriber::decode(std::shared_ptr<const JanusMessage> message) const
+	{
+		PluginClient::decode(message);
+
+		auto vrEvent = message->view<vr::VideoRoomEvent>();
+		if (vrEvent && vrEvent->plugindata && vrEvent->plugindata->data) {
+			if (vrEvent->plugindata->data->videoroom.value_or("") == "attached") {
+				message->view<vr::AttachedEvent>();
+			}
+		}
+	}
+
+	void VideoRoomSubscriber::onMessage(std::shared_ptr<const JanusMessage> message)
 	{
 		DLOG(" ::: Got a message (subscriber) :::");
 
-		std::string err;
-		std::shared_ptr<vr::VideoRoomEvent> vrEvent = fromJsonString<vr::VideoRoomEvent>(data, err);
-		if (!err.empty()) {
-			DLOG("parse JanusResponse failed");
+		auto vrEvent = message->view<vr::VideoRoomEvent>();
+		if (!vrEvent || !vrEvent->plugindata || !vrEvent->plugindata->data) {
+			DLOG("parse VideoRoomEvent failed");
 			return;
 		}
 
@@ -258,10 +290,11 @@ namespace vi {
 
 		if (event.value_or("") == "attached") {
 			_attached = true;
-			std::string err;
-			std::shared_ptr<vr::AttachedEvent> aEvent = fromJsonString<vr::AttachedEvent>(data, err);
-			if (!err.empty()) {
-				DLOG("parse JanusResponse failed");
+			// Janus took the join, the next streams go with an update
+			_joined = true;
+			auto aEvent = message->view<vr::AttachedEvent>();
+			if (!aEvent || !aEvent->plugindata || !aEvent->plugindata->data) {
+				DLOG("parse AttachedEvent failed");
 				return;
 			}
 
@@ -274,16 +307,16 @@ namespace vi {
 
 			if (pluginData->data->error) {
 				DLOG("error event: {}", pluginData->data->error.value_or(""));
+				_subscriptions->acknowledge(false);
 			}
 		}
 
-		if (jsepString.empty()) {
-			return;
-		}
-		err.clear();
-		std::shared_ptr<Jsep> jsep = fromJsonString<Jsep>(jsepString, err);
-		if (!err.empty()) {
-			DLOG("parse JanusResponse failed");
+		auto jsep = message->view<Jsep>("jsep");
+		if (!jsep) {
+			if (event.value_or("") == "updated") {
+				// nothing to renegotiate
+				_subscriptions->acknowledge(true);
+			}
 			return;
 		}
 
@@ -303,8 +336,12 @@ namespace vi {
 					request.room = roomId;
 
 					std::shared_ptr<MessageEvent> event = std::make_shared<vi::MessageEvent>();
-					auto lambda = [](bool success, const std::string& response) {
+					auto lambda = [wself](bool success, const std::string& response) {
 						DLOG("response: {}", response.c_str());
+						// the renegotiation is complete, the next subscription update may go
+						if (auto self = std::dynamic_pointer_cast<VideoRoomSubscriber>(wself.lock())) {
+							self->_subscriptions->acknowledge(success);
+						}
 					};
 
 					std::shared_ptr<vi::EventCallback> callback = std::make_shared<vi::EventCallback>(lambda);
@@ -318,6 +355,9 @@ namespace vi {
 				}
 				else {
 					DLOG("WebRTC error: {}", reason.c_str());
+					if (auto subscriber = std::dynamic_pointer_cast<VideoRoomSubscriber>(self)) {
+						subscriber->_subscriptions->acknowledge(false);
+					}
 				}
 			});
 			MediaConfig media;
@@ -342,15 +382,25 @@ namespace vi {
 
 	}
 
-	void VideoRoomSubscriber::onCleanup() 
+	void VideoRoomSubscriber::onCleanup(std::shared_ptr<TeardownCoordinator> teardown)
 	{
-		PluginClient::onCleanup();
+		PluginClient::onCleanup(teardown);
 	}
 
-	void VideoRoomSubscriber::onDetached() {}
+	void VideoRoomSubscriber::onDetached()
+	{
+		// attached again by the next subscribeTo(), which sends all that is desired
+		_attachRequested = false;
+		_handleAttached = false;
+		_joined = false;
+		_subscriptions->reset();
+	}
 
 	void VideoRoomSubscriber::onRemoteTrack(rtc::scoped_refptr<webrtc::MediaStreamTrackInterface> track, const std::string& mid, bool on)
 	{
+		if (!on && _qualityController) {
+			_qualityController->remove(mid);
+		}
 		if (auto mc = _mediaController.lock()) {
 			mc->onRemoteTrack(track, mid, on);
 		}
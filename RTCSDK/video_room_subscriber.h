@@ -4,18 +4,19 @@
 #include "plugin_client.h"
 #include "utils/universal_observable.hpp"
 #include "video_room_models.h"
+#include "subscription_manager.h"
 
 namespace vi {
 	class IVideoRoomEventHandler;
 	class IVideoRoomApi;
 	class MediaController;
-
-	using DelayedTask = std::function<void()>;
+	class SubscriptionQualityController;
 
 	class VideoRoomSubscriber : public PluginClient, public UniversalObservable<IVideoRoomEventHandler>
 	{
 	public:
-		VideoRoomSubscriber(std::shared_ptr<SignalingClientInterface> sc, 
+		VideoRoomSubscriber(std::shared_ptr<ThreadProvider> threads,
+			std::shared_ptr<SignalingClientInterface> sc, 
 			rtc::scoped_refptr<webrtc::PeerConnectionFactoryInterface> pcf, 
 			const std::string& pluginName, 
 			const std::string& opaqueId,
@@ -40,6 +41,15 @@ namespace vi {
 
 		void unsubscribeFrom(int64_t id);
 
+		// |id| unpublished or left, Janus removed its streams from this subscription already
+		void onPublisherLeft(int64_t id);
+
+		// Size of the view the video with |mid| is rendered in, picks the substream Janus forwards for it
+		void setViewSize(const std::string& mid, int width, int height);
+
+		// Pauses the video with |mid| on Janus while its view is not visible
+		void setViewVisible(const std::string& mid, bool visible);
+
 	protected:
 
 		// signaling event
@@ -52,7 +62,9 @@ namespace vi {
 
 		void onSlowLink(bool uplink, bool lost, const std::string& mid) override;
 
-		void onMessage(const std::string& data, const std::string& jsep) override;
+		void onMessage(std::shared_ptr<const JanusMessage> message) override;
+
+		void decode(std::shared_ptr<const JanusMessage> message) const override;
 
 		void onTimeout()override;
 
@@ -60,7 +72,7 @@ namespace vi {
 
 		void onHangup() override;
 
-		void onCleanup() override;
+		void onCleanup(std::shared_ptr<TeardownCoordinator> teardown) override;
 
 		void onDetached() override;
 
@@ -73,9 +85,11 @@ namespace vi {
 		void onStatsDelivered(const rtc::scoped_refptr<const webrtc::RTCStatsReport>& report) override;
 
 	private:
-		void join(const std::vector<vr::Publisher>& publishers);
+		bool sendSubscriptionUpdate(const std::vector<SubscriptionManager::Stream>& subscribe, const std::vector<SubscriptionManager::Stream>& unsubscribe);
 
-		void subscribe(const std::vector<vr::Publisher>& publishers);
+		void join(const std::vector<SubscriptionManager::Stream>& streams);
+
+		void update(const std::vector<SubscriptionManager::Stream>& subscribe, const std::vector<SubscriptionManager::Stream>& unsubscribe);
 
 	private:
 		std::string _roomId;
@@ -84,10 +98,19 @@ namespace vi {
 
 		std::atomic_bool _attached;
 
-		std::vector<vr::Publisher> _publishers;
+		bool _attachRequested = false;
+
+		bool _handleAttached = false;
+
+		bool _joined = false;
 
-		DelayedTask _joinTask;
+		std::shared_ptr<SubscriptionManager> _subscriptions;
 
 		std::weak_ptr<MediaController> _mediaController;
+
+		// requests on the handle of this subscriber, |_videoRoomApi| is the publisher's one
+		std::shared_ptr<IVideoRoomApi> _subscriberApi;
+
+		std::shared_ptr<SubscriptionQualityController> _qualityController;
 	};
 }
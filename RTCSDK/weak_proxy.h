@@ -31,11 +31,13 @@
 
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include "rtc_base/event.h"
 #include "rtc_base/message_handler.h"
 #include "rtc_base/system/rtc_export.h"
 #include "rtc_base/thread.h"
+#include "proxy_future.h"
 
 namespace rtc {
 	class Location;
@@ -493,4 +495,124 @@ namespace vi {
     return call.Marshal(RTC_FROM_HERE, thread_);							  \
   }
 
-}  
+// Asynchronous variants, the calling thread does not wait for the proxy thread:
+//
+// WEAK_PROXY_ASYNC_METHODn(method, ...) implements a void method that posts the call and returns
+// at once. The posted call holds the object, calls keep their order, and a call made on the proxy
+// thread itself runs inline.
+//
+// WEAK_PROXY_FUTURE_METHODn(r, method, ...) implements |method|Async, returning a ProxyFuture<r>
+// that is fulfilled with the result of |method| on the proxy thread. The interface declares
+// |method|Async next to |method|, the object itself may simply return ProxyFuture<r>::ready().
+
+#define WEAK_PROXY_ASYNC_METHOD0(method)                   \
+  void method() override {                                 \
+    if (thread_->IsCurrent()) {                            \
+      c_->method();                                        \
+      return;                                              \
+    }                                                      \
+    thread_->PostTask(RTC_FROM_HERE, [c = c_]() mutable {  \
+      c->method();                                         \
+    });                                                    \
+  }
+
+#define WEAK_PROXY_ASYNC_METHOD1(method, t1)               \
+  void method(t1 a1) override {                            \
+    if (thread_->IsCurrent()) {                            \
+      c_->method(std::move(a1));                           \
+      return;                                              \
+    }                                                      \
+    thread_->PostTask(RTC_FROM_HERE, [c = c_,              \
+        a1 = std::decay_t<t1>(std::move(a1))]() mutable {  \
+      c->method(std::move(a1));                            \
+    });                                                    \
+  }
+
+#define WEAK_PROXY_ASYNC_METHOD2(method, t1, t2)           \
+  void method(t1 a1, t2 a2) override {                     \
+    if (thread_->IsCurrent()) {                            \
+      c_->method(std::move(a1), std::move(a2));            \
+      return;                                              \
+    }                                                      \
+    thread_->PostTask(RTC_FROM_HERE, [c = c_,              \
+        a1 = std::decay_t<t1>(std::move(a1)),              \
+        a2 = std::decay_t<t2>(std::move(a2))]() mutable {  \
+      c->method(std::move(a1), std::move(a2));             \
+    });                                                    \
+  }
+
+#define WEAK_PROXY_ASYNC_METHOD3(method, t1, t2, t3)            \
+  void method(t1 a1, t2 a2, t3 a3) override {                   \
+    if (thread_->IsCurrent()) {                                 \
+      c_->method(std::move(a1), std::move(a2), std::move(a3));  \
+      return;                                                   \
+    }                                                           \
+    thread_->PostTask(RTC_FROM_HERE, [c = c_,                   \
+        a1 = std::decay_t<t1>(std::move(a1)),                   \
+        a2 = std::decay_t<t2>(std::move(a2)),                   \
+        a3 = std::decay_t<t3>(std::move(a3))]() mutable {       \
+      c->method(std::move(a1), std::move(a2), std::move(a3));   \
+    });                                                         \
+  }
+
+#define WEAK_PROXY_ASYNC_METHOD4(method, t1, t2, t3, t4)                       \
+  void method(t1 a1, t2 a2, t3 a3, t4 a4) override {                           \
+    if (thread_->IsCurrent()) {                                                \
+      c_->method(std::move(a1), std::move(a2), std::move(a3), std::move(a4));  \
+      return;                                                                  \
+    }                                                                          \
+    thread_->PostTask(RTC_FROM_HERE, [c = c_,                                  \
+        a1 = std::decay_t<t1>(std::move(a1)),                                  \
+        a2 = std::decay_t<t2>(std::move(a2)),                                  \
+        a3 = std::decay_t<t3>(std::move(a3)),                                  \
+        a4 = std::decay_t<t4>(std::move(a4))]() mutable {                      \
+      c->method(std::move(a1), std::move(a2), std::move(a3), std::move(a4));   \
+    });                                                                        \
+  }
+
+#define WEAK_PROXY_ASYNC_METHOD5(method, t1, t2, t3, t4, t5)                                  \
+  void method(t1 a1, t2 a2, t3 a3, t4 a4, t5 a5) override {                                   \
+    if (thread_->IsCurrent()) {                                                               \
+      c_->method(std::move(a1), std::move(a2), std::move(a3), std::move(a4), std::move(a5));  \
+      return;                                                                                 \
+    }                                                                                         \
+    thread_->PostTask(RTC_FROM_HERE, [c = c_,                                                 \
+        a1 = std::decay_t<t1>(std::move(a1)),                                                 \
+        a2 = std::decay_t<t2>(std::move(a2)),                                                 \
+        a3 = std::decay_t<t3>(std::move(a3)),                                                 \
+        a4 = std::decay_t<t4>(std::move(a4)),                                                 \
+        a5 = std::decay_t<t5>(std::move(a5))]() mutable {                                     \
+      c->method(std::move(a1), std::move(a2), std::move(a3), std::move(a4), std::move(a5));   \
+    });                                                                                       \
+  }
+
+#define WEAK_PROXY_FUTURE_METHOD0(r, method)                       \
+  ProxyFuture<r> method##Async() override {                        \
+    ProxyFuture<r> future;                                         \
+    thread_->PostTask(RTC_FROM_HERE, [c = c_, future]() mutable {  \
+      future.set(c->method());                                     \
+    });                                                            \
+    return future;                                                 \
+  }
+
+#define WEAK_PROXY_FUTURE_METHOD1(r, method, t1)           \
+  ProxyFuture<r> method##Async(t1 a1) override {           \
+    ProxyFuture<r> future;                                 \
+    thread_->PostTask(RTC_FROM_HERE, [c = c_, future,      \
+        a1 = std::decay_t<t1>(std::move(a1))]() mutable {  \
+      future.set(c->method(std::move(a1)));                \
+    });                                                    \
+    return future;                                         \
+  }
+
+#define WEAK_PROXY_FUTURE_METHOD2(r, method, t1, t2)        \
+  ProxyFuture<r> method##Async(t1 a1, t2 a2) override {     \
+    ProxyFuture<r> future;                                  \
+    thread_->PostTask(RTC_FROM_HERE, [c = c_, future,       \
+        a1 = std::decay_t<t1>(std::move(a1)),               \
+        a2 = std::decay_t<t2>(std::move(a2))]() mutable {   \
+      future.set(c->method(std::move(a1), std::move(a2)));  \
+    });                                                     \
+    return future;                                          \
+  }
+}
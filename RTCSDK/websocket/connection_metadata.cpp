@@ -33,6 +33,11 @@ namespace vi {
 
 		client::connection_ptr con = c->get_con_from_hdl(hdl);
 		_server = con->get_response_header("Server");
+#ifdef WEBSOCKET_PERMESSAGE_DEFLATE
+		_permessageDeflate = kPermessageDeflateSupported && PermessageDeflateState::negotiated();
+		PermessageDeflateState::negotiated() = false;
+#endif
+		DLOG("> permessage-deflate: {}", _permessageDeflate ? "on" : "off");
 		if (auto listener = _listener.lock()) {
 			listener->onOpen();
 		}
@@ -72,6 +77,16 @@ namespace vi {
 	}
 
 	void ConnectionMetadata::onMessage(client* c, websocketpp::connection_hdl, client::message_ptr msg) {
+		const size_t size = msg->get_payload().size();
+		_messagesReceived.fetch_add(1, std::memory_order_relaxed);
+		_bytesReceived.fetch_add(size, std::memory_order_relaxed);
+		if (msg->get_compressed()) {
+			_compressedMessagesReceived.fetch_add(1, std::memory_order_relaxed);
+#ifdef WEBSOCKET_PERMESSAGE_DEFLATE
+			_compressedBytesReceived.fetch_add(PermessageDeflateState::takeWireBytes(&msg->get_payload()), std::memory_order_relaxed);
+#endif
+		}
+
 		if (auto listener = _listener.lock()) {
 			if (msg->get_opcode() == websocketpp::frame::opcode::text) {
 				//DLOG("> received text message: {}", msg->get_payload());
@@ -118,11 +133,35 @@ namespace vi {
 		return _status;
 	}
 
+	bool ConnectionMetadata::permessageDeflate() const {
+		return _permessageDeflate;
+	}
+
+	void ConnectionMetadata::onSent(size_t size) {
+		_messagesSent.fetch_add(1, std::memory_order_relaxed);
+		_bytesSent.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	TrafficStats ConnectionMetadata::trafficStats() const {
+		TrafficStats stats;
+		stats.messagesSent = _messagesSent.load(std::memory_order_relaxed);
+		stats.messagesReceived = _messagesReceived.load(std::memory_order_relaxed);
+		stats.bytesSent = _bytesSent.load(std::memory_order_relaxed);
+		stats.bytesReceived = _bytesReceived.load(std::memory_order_relaxed);
+		stats.compressedMessagesReceived = _compressedMessagesReceived.load(std::memory_order_relaxed);
+		stats.compressedBytesReceived = _compressedBytesReceived.load(std::memory_order_relaxed);
+		return stats;
+	}
+
 	std::ostream & operator<< (std::ostream& out, ConnectionMetadata const& data) {
 		out << "> URI: " << data._uri << "\n"
 			<< "> Status: " << data._status << "\n"
 			<< "> Remote Server: " << (data._server.empty() ? "None Specified" : data._server) << "\n"
-			<< "> Error/close reason: " << (data._errorReason.empty() ? "N/A" : data._errorReason) << "\n";
+			<< "> Error/close reason: " << (data._errorReason.empty() ? "N/A" : data._errorReason) << "\n"
+			<< "> permessage-deflate: " << (data._permessageDeflate ? "on" : "off") << "\n"
+			<< "> Received: " << data._messagesReceived << " messages, " << data._bytesReceived << " bytes ("
+			<< data._compressedMessagesReceived << " compressed, " << data._compressedBytesReceived << " bytes on the wire)\n"
+			<< "> Sent: " << data._messagesSent << " messages, " << data._bytesSent << " bytes\n";
 		return out;
 	}
 
@@ -7,17 +7,23 @@
 #pragma once
 
 #include <memory>
-
-//#include <websocketpp/config/asio_no_tls_client.hpp>
-#include <websocketpp/config/asio_client.hpp>
-#include <websocketpp/client.hpp>
+#include <atomic>
+#include "websocket/websocket_config.h"
 #include "websocket/i_connection_listener.h"
 
-
-//typedef websocketpp::client<websocketpp::config::asio_client> client;
-typedef websocketpp::client<websocketpp::config::asio_tls_client> client;
-
 namespace vi {
+	// Message and payload byte counters of a connection. Payload bytes are counted uncompressed:
+	// websocketpp inflates a message before handing it over and deflates it after it is queued.
+	// Only the compressed size of received messages is known, from the deflate extension.
+	struct TrafficStats {
+		uint64_t messagesSent = 0;
+		uint64_t messagesReceived = 0;
+		uint64_t bytesSent = 0;
+		uint64_t bytesReceived = 0;
+		// messages that arrived with the per-message compressed bit (RSV1) set, and their size on the wire
+		uint64_t compressedMessagesReceived = 0;
+		uint64_t compressedBytesReceived = 0;
+	};
 
 	class ConnectionMetadata {
 	public:
@@ -47,6 +53,13 @@ namespace vi {
 
 		std::string getStatus() const;
 
+		// true once the server accepted the permessage-deflate offer
+		bool permessageDeflate() const;
+
+		void onSent(size_t size);
+
+		TrafficStats trafficStats() const;
+
 		friend std::ostream & operator<< (std::ostream& out, ConnectionMetadata const& data);
 	private:
 		int _id;
@@ -56,6 +69,13 @@ namespace vi {
 		std::string _server;
 		std::string _errorReason;
 		std::weak_ptr<IConnectionListener> _listener;
+		std::atomic_bool _permessageDeflate = false;
+		std::atomic<uint64_t> _messagesSent{ 0 };
+		std::atomic<uint64_t> _messagesReceived{ 0 };
+		std::atomic<uint64_t> _bytesSent{ 0 };
+		std::atomic<uint64_t> _bytesReceived{ 0 };
+		std::atomic<uint64_t> _compressedMessagesReceived{ 0 };
+		std::atomic<uint64_t> _compressedBytesReceived{ 0 };
 	};
 
 }
@@ -0,0 +1,133 @@
+/**
+ * This file is part of janus_client project.
+ * Author:    Jackie Ou
+ * Created:   2020-10-01
+ **/
+
+#pragma once
+
+//#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/config/asio_client.hpp>
+#include <websocketpp/client.hpp>
+
+// Define WEBSOCKET_PERMESSAGE_DEFLATE (and link zlib) to offer the permessage-deflate
+// extension (RFC 7692) to the server. Whether it is used is up to the server, see
+// ConnectionMetadata::permessageDeflate().
+#ifdef WEBSOCKET_PERMESSAGE_DEFLATE
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <websocketpp/version.hpp>
+#include <websocketpp/extensions/permessage_deflate/enabled.hpp>
+
+namespace vi {
+	// websocketpp offers the extension from a client and negotiates the server's answer since 0.8.0,
+	// older versions take the config but never enable it on a client connection, they get the plain one
+	const bool kPermessageDeflateSupported = websocketpp::major_version > 0 || websocketpp::minor_version >= 8;
+
+	// What deflate_extension saw, for ConnectionMetadata to pick up.
+	struct PermessageDeflateState {
+		// Result of the last negotiation on the calling thread. websocketpp negotiates the handshake
+		// response and calls the open handler in the same handler, so it is that connection's.
+		static bool& negotiated()
+		{
+			static thread_local bool value = false;
+			return value;
+		}
+
+		// Compressed bytes inflated into |payload|, websocketpp inflates straight into the payload
+		// of the message being read; taken once the message is handed over.
+		static void addWireBytes(const std::string* payload, size_t size)
+		{
+			std::lock_guard<std::mutex> locker(mutex());
+			wireBytes()[payload] += size;
+		}
+
+		static size_t takeWireBytes(const std::string* payload)
+		{
+			std::lock_guard<std::mutex> locker(mutex());
+			auto it = wireBytes().find(payload);
+			if (it == wireBytes().end()) {
+				return 0;
+			}
+			size_t size = it->second;
+			wireBytes().erase(it);
+			return size;
+		}
+
+	private:
+		static std::mutex& mutex()
+		{
+			static std::mutex value;
+			return value;
+		}
+
+		static std::unordered_map<const std::string*, size_t>& wireBytes()
+		{
+			static std::unordered_map<const std::string*, size_t> value;
+			return value;
+		}
+	};
+
+	// The permessage-deflate extension of websocketpp, reporting to PermessageDeflateState. The
+	// processor calls its extension statically, so hiding the methods is enough.
+	template <typename config>
+	class deflate_extension : public websocketpp::extensions::permessage_deflate::enabled<config> {
+		typedef websocketpp::extensions::permessage_deflate::enabled<config> base;
+
+	public:
+		std::pair<websocketpp::lib::error_code, std::string> negotiate(websocketpp::http::attribute_list const& offer)
+		{
+			auto result = base::negotiate(offer);
+			PermessageDeflateState::negotiated() = base::is_enabled();
+			return result;
+		}
+
+		websocketpp::lib::error_code decompress(uint8_t const* buf, size_t len, std::string& out)
+		{
+			PermessageDeflateState::addWireBytes(&out, len);
+			return base::decompress(buf, len, out);
+		}
+	};
+
+	struct deflate_tls_client_config : public websocketpp::config::asio_tls_client {
+		typedef deflate_tls_client_config type;
+		typedef websocketpp::config::asio_tls_client base;
+
+		typedef base::concurrency_type concurrency_type;
+
+		typedef base::request_type request_type;
+		typedef base::response_type response_type;
+
+		typedef base::message_type message_type;
+		typedef base::con_msg_manager_type con_msg_manager_type;
+		typedef base::endpoint_msg_manager_type endpoint_msg_manager_type;
+
+		typedef base::alog_type alog_type;
+		typedef base::elog_type elog_type;
+
+		typedef base::rng_type rng_type;
+
+		struct transport_config : public base::transport_config {
+			typedef type::concurrency_type concurrency_type;
+			typedef type::alog_type alog_type;
+			typedef type::elog_type elog_type;
+			typedef type::request_type request_type;
+			typedef type::response_type response_type;
+			typedef websocketpp::transport::asio::tls_socket::endpoint socket_type;
+		};
+
+		typedef websocketpp::transport::asio::endpoint<transport_config> transport_type;
+
+		struct permessage_deflate_config {};
+
+		typedef deflate_extension<permessage_deflate_config> permessage_deflate_type;
+	};
+}
+
+typedef websocketpp::client<std::conditional<vi::kPermessageDeflateSupported, vi::deflate_tls_client_config, websocketpp::config::asio_tls_client>::type> client;
+#else
+//typedef websocketpp::client<websocketpp::config::asio_client> client;
+typedef websocketpp::client<websocketpp::config::asio_tls_client> client;
+#endif
@@ -10,6 +10,7 @@
 #include "websocket_endpoint.h"
 #include "websocket/i_connection_listener.h"
 #include "logger/logger.h"
+#include <algorithm>
 #include <websocketpp/config/asio_client.hpp>
 #include <websocketpp/transport/asio/endpoint.hpp>
 #include <websocketpp/transport/asio/security/tls.hpp>
@@ -185,7 +186,7 @@ namespace {
 }
 
 namespace vi {
-	WebsocketEndpoint::WebsocketEndpoint()
+	WebsocketEndpoint::WebsocketEndpoint(size_t threadCount)
 		: _nextId(0) {
 		_endpoint.clear_access_channels(websocketpp::log::alevel::all);
 		_endpoint.clear_error_channels(websocketpp::log::elevel::all);
@@ -195,12 +196,29 @@ namespace vi {
 		_endpoint.set_tls_init_handler(bind(&on_tls_init, "", ::_1));
 		_endpoint.start_perpetual();
 
-		_thread = websocketpp::lib::make_shared<websocketpp::lib::thread>(&client::run, &_endpoint);
+		for (size_t i = 0; i < std::max<size_t>(threadCount, 1); ++i) {
+			_threads.emplace_back(websocketpp::lib::make_shared<websocketpp::lib::thread>(&client::run, &_endpoint));
+		}
+	}
+
+	std::shared_ptr<WebsocketEndpoint> WebsocketEndpoint::shared() {
+		static std::mutex mutex;
+		static std::weak_ptr<WebsocketEndpoint> instance;
+
+		std::lock_guard<std::mutex> locker(mutex);
+		auto endpoint = instance.lock();
+		if (!endpoint) {
+			size_t threadCount = std::min<size_t>(std::max<size_t>(std::thread::hardware_concurrency() / 2, 1), 4);
+			endpoint = std::make_shared<WebsocketEndpoint>(threadCount);
+			instance = endpoint;
+		}
+		return endpoint;
 	}
 
 	WebsocketEndpoint::~WebsocketEndpoint() {
 		_endpoint.stop_perpetual();
 
+		std::unique_lock<std::mutex> locker(_mutex);
 		for (ConnectionList::const_iterator it = _connectionList.begin(); it != _connectionList.end(); ++it) {
 			if (it->second->getStatus() != "Open") {
 				// Only close open connections
@@ -216,8 +234,12 @@ namespace vi {
 			}
 		}
 
-		if (_thread->joinable()) {
-			_thread->join();
+		locker.unlock();
+
+		for (const auto& thread : _threads) {
+			if (thread->joinable()) {
+				thread->join();
+			}
 		}
 	}
 
@@ -245,9 +267,14 @@ namespace vi {
 			}
 		}
 
-		int newId = _nextId++;
-		ConnectionMetadata::ptr metadataPtr = websocketpp::lib::make_shared<ConnectionMetadata>(newId, con->get_handle(), uri, listener);
-		_connectionList[newId] = metadataPtr;
+		int newId = -1;
+		ConnectionMetadata::ptr metadataPtr;
+		{
+			std::lock_guard<std::mutex> locker(_mutex);
+			newId = _nextId++;
+			metadataPtr = websocketpp::lib::make_shared<ConnectionMetadata>(newId, con->get_handle(), uri, listener);
+			_connectionList[newId] = metadataPtr;
+		}
 
 		con->set_open_handler(websocketpp::lib::bind(
 			&ConnectionMetadata::onOpen,
@@ -307,61 +334,71 @@ namespace vi {
 	void WebsocketEndpoint::close(int id, websocketpp::close::status::value code, const std::string& reason) {
 		websocketpp::lib::error_code ec;
 
-		ConnectionList::iterator metadataIt = _connectionList.find(id);
-		if (metadataIt == _connectionList.end()) {
+		websocketpp::connection_hdl hdl = getHdl(id);
+		if (hdl.expired()) {
 			ELOG("> No connection found with id: {}", id);
 			return;
 		}
 
-		_endpoint.close(metadataIt->second->getHdl(), code, reason, ec);
+		_endpoint.close(hdl, code, reason, ec);
 		if (ec) {
 			ELOG("> Error initiating close: {}", ec.message());
 		}
 	}
 
 	void WebsocketEndpoint::sendText(int id, const std::string& data) {
+		sendText(id, data.data(), data.size());
+	}
+
+	void WebsocketEndpoint::sendText(int id, const char* data, size_t size) {
 		websocketpp::lib::error_code ec;
 
-		ConnectionList::iterator metadataIt = _connectionList.find(id);
-		if (metadataIt == _connectionList.end()) {
+		websocketpp::connection_hdl hdl = getHdl(id);
+		if (hdl.expired()) {
 			ELOG("> No connection found with id: {}", id);
 			return;
 		}
 
-		_endpoint.send(metadataIt->second->getHdl(), data, websocketpp::frame::opcode::text, ec);
+		_endpoint.send(hdl, data, size, websocketpp::frame::opcode::text, ec);
 		if (ec) {
 			ELOG("> Error sending text message: {}", ec.message());
 			return;
 		}
+		if (auto metadata = getMetadata(id)) {
+			metadata->onSent(size);
+		}
 	}
 
 	void WebsocketEndpoint::sendBinary(int id, const std::vector<uint8_t>& data)
 	{
 		websocketpp::lib::error_code ec;
 
-		ConnectionList::iterator metadataIt = _connectionList.find(id);
-		if (metadataIt == _connectionList.end()) {
+		websocketpp::connection_hdl hdl = getHdl(id);
+		if (hdl.expired()) {
 			ELOG("> No connection found with id: {}", id);
 			return;
 		}
 
-		_endpoint.send(metadataIt->second->getHdl(), data.data(), data.size(), websocketpp::frame::opcode::binary, ec);
+		_endpoint.send(hdl, data.data(), data.size(), websocketpp::frame::opcode::binary, ec);
 		if (ec) {
 			ELOG("> Error sending binary message: {}", ec.message());
 			return;
 		}
+		if (auto metadata = getMetadata(id)) {
+			metadata->onSent(data.size());
+		}
 	}
 
 	void WebsocketEndpoint::sendPing(int id, const std::string& data) {
 		websocketpp::lib::error_code ec;
 
-		ConnectionList::iterator metadataIt = _connectionList.find(id);
-		if (metadataIt == _connectionList.end()) {
+		websocketpp::connection_hdl hdl = getHdl(id);
+		if (hdl.expired()) {
 			ELOG("> No connection found with id: {}", id);
 			return;
 		}
 
-		_endpoint.send(metadataIt->second->getHdl(), data, websocketpp::frame::opcode::ping, ec);
+		_endpoint.send(hdl, data, websocketpp::frame::opcode::ping, ec);
 		if (ec) {
 			ELOG("> Error sending ping message: {}", ec.message());
 			return;
@@ -371,20 +408,36 @@ namespace vi {
 	void WebsocketEndpoint::sendPong(int id, const std::string& data) {
 		websocketpp::lib::error_code ec;
 
-		ConnectionList::iterator metadataIt = _connectionList.find(id);
-		if (metadataIt == _connectionList.end()) {
+		websocketpp::connection_hdl hdl = getHdl(id);
+		if (hdl.expired()) {
 			ELOG("> No connection found with id: {}", id);
 			return;
 		}
 
-		_endpoint.send(metadataIt->second->getHdl(), data, websocketpp::frame::opcode::pong, ec);
+		_endpoint.send(hdl, data, websocketpp::frame::opcode::pong, ec);
 		if (ec) {
 			ELOG("> Error sending pong message: {}", ec.message());
 			return;
 		}
 	}
 
+	size_t WebsocketEndpoint::bufferedAmount(int id) {
+		websocketpp::lib::error_code ec;
+
+		websocketpp::connection_hdl hdl = getHdl(id);
+		if (hdl.expired()) {
+			return 0;
+		}
+
+		client::connection_ptr con = _endpoint.get_con_from_hdl(hdl, ec);
+		if (ec || !con) {
+			return 0;
+		}
+		return con->get_buffered_amount();
+	}
+
 	ConnectionMetadata::ptr WebsocketEndpoint::getMetadata(int id) const {
+		std::lock_guard<std::mutex> locker(_mutex);
 		ConnectionList::const_iterator metadataIt = _connectionList.find(id);
 		if (metadataIt == _connectionList.end()) {
 			return ConnectionMetadata::ptr();
@@ -393,4 +446,13 @@ namespace vi {
 			return metadataIt->second;
 		}
 	}
+
+	websocketpp::connection_hdl WebsocketEndpoint::getHdl(int id) const {
+		std::lock_guard<std::mutex> locker(_mutex);
+		ConnectionList::const_iterator metadataIt = _connectionList.find(id);
+		if (metadataIt == _connectionList.end()) {
+			return websocketpp::connection_hdl();
+		}
+		return metadataIt->second->getHdl();
+	}
 }
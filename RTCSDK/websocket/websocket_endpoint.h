@@ -14,11 +14,18 @@
 #include <websocketpp/common/memory.hpp>
 #include <string>
 #include <vector>
+#include <mutex>
 
 namespace vi {
+	// Owns an asio io_context and the threads running it. websocketpp serializes the handlers
+	// of each connection on its own strand, so several threads can drive many connections.
 	class WebsocketEndpoint {
 	public:
-		WebsocketEndpoint();
+		explicit WebsocketEndpoint(size_t threadCount = 1);
+
+		// Process-wide endpoint driven by a small fixed pool of threads, for processes running many
+		// clients. It lives as long as someone holds it.
+		static std::shared_ptr<WebsocketEndpoint> shared();
 
 		~WebsocketEndpoint();
 
@@ -28,20 +35,31 @@ namespace vi {
 
 		void sendText(int id, const std::string& data);
 
+		// Sends |size| bytes at |data| as one text frame, the bytes are copied straight into the frame.
+		void sendText(int id, const char* data, size_t size);
+
 		void sendBinary(int id, const std::vector<uint8_t>& data);
 
 		void sendPing(int id, const std::string& data);
 
 		void sendPong(int id, const std::string& data);
 
+		// Bytes queued on the connection but not yet written to the socket, 0 if |id| is unknown.
+		size_t bufferedAmount(int id);
+
 		ConnectionMetadata::ptr getMetadata(int id) const;
 
 	private:
 		typedef std::map<int, ConnectionMetadata::ptr> ConnectionList;
 
+		// returns a null handle if |id| is unknown
+		websocketpp::connection_hdl getHdl(int id) const;
+
+	private:
 		client _endpoint;
-		websocketpp::lib::shared_ptr<websocketpp::lib::thread> _thread;
+		std::vector<websocketpp::lib::shared_ptr<websocketpp::lib::thread>> _threads;
 
+		mutable std::mutex _mutex;
 		ConnectionList _connectionList;
 		int _nextId;
 	};
@@ -7,6 +7,7 @@
 #include "gallery_view.h"
 #include "ui_gallery_view.h"
 #include <QGridLayout>
+#include <QTimer>
 #include "gl_video_renderer.h"
 
 GalleryView::GalleryView(QWidget *parent) :
@@ -85,6 +86,31 @@ void GalleryView::removeAll()
     permuteViews();
 }
 
+void GalleryView::showEvent(QShowEvent* event)
+{
+    QFrame::showEvent(event);
+    updateVisibility();
+}
+
+void GalleryView::hideEvent(QHideEvent* event)
+{
+    // minimizing sends a spontaneous one
+    QFrame::hideEvent(event);
+    updateVisibility();
+}
+
+void GalleryView::updateVisibility()
+{
+    const bool shown = isVisible() && !window()->isMinimized();
+    for (const auto& v : _views) {
+        const bool visible = shown && v->view()->isVisible() && !v->view()->visibleRegion().isEmpty();
+        if (v->isVisible() != visible) {
+            v->setVisible(visible);
+            emit viewVisibilityChanged(v->id(), visible);
+        }
+    }
+}
+
 void GalleryView::permute(Strategy strategy)
 {
     if (auto ds = getPermuteStrategy(strategy)) {
@@ -124,4 +150,7 @@ void GalleryView::permuteViews()
         }
     }
 
+    // the views are laid out and shown once the event loop runs again
+    QTimer::singleShot(0, this, &GalleryView::updateVisibility);
+
 }
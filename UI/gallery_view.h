@@ -30,6 +30,9 @@ public:
 	virtual void cleanup() = 0;
 	virtual int64_t id() = 0;
 	virtual QWidget* view() = 0;
+	// a hidden view does not take frames
+	virtual void setVisible(bool visible) = 0;
+	virtual bool isVisible() = 0;
 };
 
 class ContentView : public IContentView {
@@ -64,12 +67,35 @@ public:
 		return static_cast<QWidget*>(_renderer);
 	}
 
+	void setVisible(bool visible) override {
+		if (_visible == visible) {
+			return;
+		}
+		_visible = visible;
+		if (!_renderer || !_track) {
+			return;
+		}
+		if (visible) {
+			rtc::VideoSinkWants wants;
+			_track->AddOrUpdateSink(_renderer, wants);
+		}
+		else {
+			_track->RemoveSink(_renderer);
+		}
+	}
+
+	bool isVisible() override {
+		return _visible;
+	}
+
 private:
     int64_t _id = -1;
 
 	rtc::scoped_refptr<webrtc::VideoTrackInterface> _track;
 
 	GLVideoRenderer* _renderer = nullptr;
+
+	bool _visible = true;
 };
 
 class PermuteStrategy {
@@ -112,9 +138,19 @@ public:
 
     void removeAll();
 
+signals:
+    // a view got hidden, minimized or clipped away, or is shown again
+    void viewVisibilityChanged(int64_t id, bool visible);
+
 protected:
     void init();
 
+    void showEvent(QShowEvent* event) override;
+
+    void hideEvent(QHideEvent* event) override;
+
+    void updateVisibility();
+
     std::shared_ptr<PermuteStrategy> getPermuteStrategy(Strategy strategys);
 
     void permute(Strategy strategy = Strategy::DEFAULT);
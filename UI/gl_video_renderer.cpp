@@ -67,6 +67,8 @@ void GLVideoRenderer::initializeGL()
 
 void GLVideoRenderer::resizeGL(int w, int h)
 {
+	emit resized(w, h);
+
 	// Update projection matrix and other size related settings:
 	//if (_frame) {
 	//	glViewport(0, 0, _frame->width(), _frame->height());
@@ -35,6 +35,10 @@ public:
 
 	void init();
 
+signals:
+	// size of the widget in device pixels
+	void resized(int width, int height);
+
 protected:
 	void initializeGL() override;
 
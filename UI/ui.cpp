@@ -73,12 +73,19 @@ void GUI::init()
 	_vrc->init();
 
 	_vrc->registerEventHandler(_videoRoomEventAdapter);
-	_vrc->mediaContrller()->registerEventHandler(_mediaEventAdapter);
+	_mediaController = _vrc->mediaContrller();
+	_mediaController->registerEventHandler(_mediaEventAdapter);
 	_vrc->participantsController()->registerEventHandler(_participantsEventAdapter);
 
 
 	_galleryView = new GalleryView(this);
 	setCentralWidget(_galleryView);
+	// Janus stops relaying what is not on screen
+	connect(_galleryView, &GalleryView::viewVisibilityChanged, this, [this](int64_t id, bool visible) {
+		if (_mediaController && id != _selfViewId) {
+			_mediaController->setRemoteViewVisible(std::to_string(id), visible);
+		}
+	});
 
 
     QWidget* dockContentView = new QWidget(this);
@@ -227,6 +234,18 @@ void GUI::onCreateVideoTrack(uint64_t pid, rtc::scoped_refptr<webrtc::VideoTrack
             renderer->init();
             renderer->show();
 
+            // a local source is the self view, the others let Janus forward the substream that fits the tile
+            if (track->GetSource() && !track->GetSource()->remote()) {
+                _selfViewId = pid;
+            }
+            else {
+                connect(renderer, &GLVideoRenderer::resized, this, [this, pid](int width, int height) {
+                    if (_mediaController) {
+                        _mediaController->setRemoteViewSize(std::to_string(pid), width, height);
+                    }
+                });
+            }
+
             std::shared_ptr<ContentView> view = std::make_shared<ContentView>(pid, track, renderer);
             view->init();
 
@@ -246,6 +265,9 @@ void GUI::onCreateVideoTrack(uint64_t pid, rtc::scoped_refptr<webrtc::VideoTrack
 
 void GUI::onRemoveVideoTrack(uint64_t pid, rtc::scoped_refptr<webrtc::VideoTrackInterface> track)
 {
+	if (static_cast<int64_t>(pid) == _selfViewId) {
+		_selfViewId = -1;
+	}
 	_galleryView->removeView(pid);
 }
 
@@ -14,6 +14,7 @@ namespace vi {
 	class Participant;
 	class ParticipantsListView;
 	class VideoRoomClientInterface;
+	class MediaControllerInterface;
 }
 
 class MediaEventAdapter;
@@ -111,6 +112,12 @@ private:
 
 	std::shared_ptr<vi::VideoRoomClientInterface> _vrc;
 
+	// fetched once, every call through _vrc is a blocking hop to its thread
+	std::shared_ptr<vi::MediaControllerInterface> _mediaController;
+
+	// the tile of the local camera, Janus relays nothing to it
+	int64_t _selfViewId = -1;
+
     //std::shared_ptr<IContentView> _selfContentView;
 
     //QWidget* _selfView;